@@ -3,36 +3,410 @@
 #define BIG_INT
 
 #include <vector>
+#include <cstdint>
+#include <climits>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <iterator>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+//vector digit kernels for x86-64, selected at run time by cpu features
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIG_INT_SIMD
+#include <immintrin.h>
+#endif
 
 class BigInt {
     private:
-        //vector stores a number in reverse
-        std::vector<int> digits_;
+        //vector of limbs with room for a few of them inside the object
+        //only longer numbers allocate memory on the heap
+        class limb_vector {
+            private:
+                //limbs kept inline before spilling to the heap
+                static constexpr size_t inline_capacity_ = 4;
+
+                //points to inline_ or to a heap block of capacity_ limbs
+                uint64_t * data_;
+
+                size_t size_;
+
+                size_t capacity_;
+
+                uint64_t inline_[inline_capacity_];
+
+                //true if data_ is a heap block
+                bool on_heap() const;
+
+            public:
+                limb_vector();
+
+                //n copies of value
+                explicit limb_vector(size_t, uint64_t = 0);
+
+                //copy of [first, last)
+                limb_vector(const uint64_t *, const uint64_t *);
+
+                limb_vector(const limb_vector &);
+
+                limb_vector(limb_vector &&) noexcept;
+
+                ~limb_vector();
+
+                limb_vector & operator=(const limb_vector &);
+
+                limb_vector & operator=(limb_vector &&) noexcept;
+
+                size_t size() const;
+
+                uint64_t * data();
+                const uint64_t * data() const;
+
+                uint64_t * begin();
+                const uint64_t * begin() const;
+
+                uint64_t * end();
+                const uint64_t * end() const;
+
+                uint64_t & operator[](size_t);
+                const uint64_t & operator[](size_t) const;
+
+                uint64_t & back();
+                const uint64_t & back() const;
+
+                //make room for at least n limbs, keeps the contents
+                void reserve(size_t);
+
+                void resize(size_t, uint64_t = 0);
+
+                void assign(size_t, uint64_t);
+
+                //copy of [first, last)
+                void assign(const uint64_t *, const uint64_t *);
+
+                void push_back(uint64_t);
+
+                void pop_back();
+
+                //insert count copies of value before pos
+                void insert(uint64_t *, size_t, uint64_t);
+
+                //erase [first, last)
+                void erase(uint64_t *, uint64_t *);
+
+                void swap(limb_vector &);
+        };
 
-        //base_ of number        
-        static const int base_ = 1'000'000'000;
+        //vector stores a number in reverse
+        //limbs are in base 2^64
+        limb_vector digits_;
 
         //the sign of number
         //if the number is negative then isNegative_ = true
         //otherwise isNegative_ = false
         bool isNegative_; 
 
-        //check if string is valid
-        void check_string(std::string);
-
         //remove redundant zeros
         void remove_leading_zeros();
 
-        //convert BigInt to string that represents binary number
-        std::string binary(BigInt) const;
+        //two's complement representation in n limbs, sign-extended
+        //n must be larger than the number of limbs
+        limb_vector twos_complement(size_t) const;
+
+        //BigInt from a two's complement representation, the top bit is the sign
+        static BigInt from_twos_complement(limb_vector &);
+
+        //limb-wise bitwise operation on two's complement representations
+        template <typename Op>
+        static BigInt bitwise(const BigInt &, const BigInt &, Op);
+
+        //number of significant bits of the magnitude, zero for zero
+        size_t bit_length() const;
+
+        //magnitude shifts behind operator<< and operator>>
+        static BigInt shift_left(const BigInt &, size_t);
+        static BigInt shift_right(const BigInt &, size_t);
+
+        //10^k
+        static BigInt power_of_ten(size_t);
+
+        //decimal conversion splits numbers by 10^(19 * 2^k), the largest power of ten in a limb squared k times
+        //numbers up to this many limbs are converted limb by limb
+        static constexpr size_t conversion_threshold_ = 32;
+
+        //10^(19 * 2^k), computed once and shared by all conversions
+        static const BigInt & decimal_power(size_t);
+
+        //number from the decimal digits [first, last), no sign
+        static BigInt from_decimal(const char *, const char *);
+
+        //number of decimal digits at the start of [first, last)
+        static size_t digit_run(const char *, const char *);
+        static size_t digit_run_scalar(const char *, const char *);
+
+        //value of 16 decimal digits
+        static uint64_t parse_16(const char *);
+        static uint64_t parse_16_scalar(const char *);
+
+        //out[i] = value of the 19 decimal digits at p + 19 * i for i < count
+        static void parse_19s(const char *, size_t, uint64_t *);
+
+#ifdef BIG_INT_SIMD
+        //16 digits per compare with sse2, which every x86-64 cpu has
+        static size_t digit_run_sse2(const char *, const char *);
+
+        //pmaddubsw/pmaddwd reduction of 16 digits
+        __attribute__((target("sse4.1")))
+        static uint64_t parse_16_sse41(const char *);
+
+        //digit runs are scanned with sse2 up to this many bytes, the rest with avx2
+        //short numbers never pay for entering the avx2 routine
+        static constexpr size_t avx2_digit_threshold_ = 64;
+
+        //32 digits per compare with avx2
+        __attribute__((target("avx2")))
+        static size_t digit_run_avx2(const char *, const char *);
+
+        //two 19-digit chunks per step, one in each 128-bit lane, returns the number of chunks done
+        __attribute__((target("avx2")))
+        static size_t parse_19s_avx2(const char *, size_t, uint64_t *);
+#endif
+
+        //pass the decimal digits of |x| to sink(const char *, size_t) from the highest, in pieces
+        //padded with leading zeros to width if width is not zero
+        template <typename Sink>
+        static void to_decimal(const BigInt &, size_t, Sink &);
+
+        //out[0, 19) = value with leading zeros, two digits per table lookup
+        static void format_19(uint64_t, char *);
+
+        //upper bound of the number of decimal digits of |x|
+        size_t decimal_bound() const;
+
+        //operands shorter than this (in limbs) are multiplied by schoolbook
+        static constexpr size_t karatsuba_threshold_ = 32;
+
+        //squares shorter than this (in limbs) are computed by schoolbook
+        //later than for products since the schoolbook square does half the work
+        static constexpr size_t sqr_karatsuba_threshold_ = 64;
+
+        //operands shorter than this (in limbs) are multiplied by karatsuba
+        static constexpr size_t toom3_threshold_ = 150;
+
+        //operands shorter than this (in limbs) are multiplied by toom-3
+        static constexpr size_t ntt_threshold_ = 16000;
+
+        //montgomery products with moduli shorter than this (in limbs) use schoolbook
+        //and need no memory besides a scratch buffer
+        static constexpr size_t montgomery_threshold_ = 128;
+
+        //longest product (in limbs) that fits the transform length of all ntt primes
+        static constexpr size_t ntt_max_size_ = 1 << 22;
+
+        //products with operands at least this long (in limbs) run their sub-products on the thread pool
+        static constexpr size_t parallel_mul_threshold_ = 512;
+
+        //transforms at least this long split their butterflies across the thread pool
+        static constexpr size_t parallel_ntt_threshold_ = 1 << 16;
+
+        //work-stealing pool shared by all operations
+        class thread_pool;
 
-        //convert from binary to BigInt
-        BigInt decimal(std::string) const;
+        //run the functions, on the thread pool if the operands of n limbs are long enough
+        template <typename... F>
+        static void parallel(size_t, F &&...);
+
+        //compare magnitudes a[0, na) and b[0, nb) without leading zeros
+        //returns -1, 0 or 1
+        static int compare_limbs(const uint64_t *, size_t, const uint64_t *, size_t);
+
+        //a[0, n) /= d, returns the remainder
+        static uint64_t div_limbs_small(uint64_t *, size_t, uint64_t);
+
+        //make a non-negative BigInt from limbs p[0, n)
+        static BigInt from_limbs(const uint64_t *, size_t);
+
+        //a[0, na) += b[0, nb), nb <= na
+        //returns the carry out of the highest limb
+        static uint64_t add_limbs(uint64_t *, size_t, const uint64_t *, size_t);
+
+        //a[0, na) -= b[0, nb), nb <= na and a >= b
+        static void sub_limbs(uint64_t *, size_t, const uint64_t *, size_t);
+
+        //res[0, n) += a[0, n) * b, returns the carry limb
+        static uint64_t addmul_1(uint64_t *, const uint64_t *, size_t, uint64_t);
+
+        //res[0, n) -= a[0, n) * b, returns the borrow limb
+        static uint64_t submul_1(uint64_t *, const uint64_t *, size_t, uint64_t);
+
+        //res[0, na + nb) = a[0, na) * b[0, nb)
+        static void mul_schoolbook(const uint64_t *, size_t, const uint64_t *, size_t, uint64_t *);
+
+        //res[0, na + nb) = a[0, na) * b[0, nb)
+        //splits operands in halves and does three recursive multiplications
+        static void mul_karatsuba(const uint64_t *, size_t, const uint64_t *, size_t, uint64_t *);
+
+        //res[0, na + nb) = a[0, na) * b[0, nb), nb <= na < 2 * nb
+        //splits operands in thirds and does five recursive multiplications
+        static void mul_toom3(const uint64_t *, size_t, const uint64_t *, size_t, uint64_t *);
+
+        //res[0, 2 * n) = a[0, n)^2
+        //every cross product a[i] * a[j] is computed once and doubled
+        static void sqr_schoolbook(const uint64_t *, size_t, uint64_t *);
+
+        //res[0, 2 * n) = a[0, n)^2
+        //2 * a0 * a1 = a0^2 + a1^2 - (a1 - a0)^2, three recursive squarings
+        static void sqr_karatsuba(const uint64_t *, size_t, uint64_t *);
+
+        //res[0, 2 * n) = a[0, n)^2
+        //one evaluation and five recursive squarings
+        static void sqr_toom3(const uint64_t *, size_t, uint64_t *);
+
+        //res[0, n) = r0 + r1 * x + r2 * x^2 + r3 * x^3 + rinf * x^4 with x = base^k
+        //from the values at 0, 1, -1, -2 and infinity, the arguments are overwritten
+        static void toom3_interpolate(BigInt &, BigInt &, BigInt &, BigInt &, BigInt &, size_t, uint64_t *, size_t);
+
+        //res[0, 2 * n) = a[0, n)^2
+        //picks the squaring algorithm by operand size
+        static void sqr_limbs(const uint64_t *, size_t, uint64_t *);
+
+        //base^exp modulo mod
+        static unsigned int pow_mod(unsigned int, unsigned long long int, unsigned int);
+
+        //in-place number-theoretic transform modulo a prime with primitive root 3
+        //inverse transform if invert is true
+        static void ntt(std::vector<unsigned int> &, bool, unsigned int);
+
+        //pieces [lo, hi) of the steps of ntt, the arguments are plain values that stores cannot alias
+        //w[k] = wlen^k
+        static void ntt_powers(unsigned int *, size_t, size_t, unsigned long long int, unsigned int);
+        //butterflies of a stage with blocks of 2 * half, butterfly j is number j % half of block j / half
+        static void ntt_butterflies(unsigned int *, const unsigned int *, size_t, size_t, size_t, unsigned int);
+        //a[i] *= factor
+        static void ntt_scale(unsigned int *, size_t, size_t, unsigned long long int, unsigned int);
+
+        //res[0, na + nb) = a[0, na) * b[0, nb), na + nb <= ntt_max_size_
+        //limbs are split in 32-bit halves, the convolution is done modulo three ntt primes
+        //and recombined by chinese remainder theorem, a square needs two transforms per prime
+        static void mul_ntt(const uint64_t *, size_t, const uint64_t *, size_t, uint64_t *);
+
+        //res[0, na + nb) = a[0, na) * b[0, nb)
+        //picks the multiplication algorithm by operand sizes, a == b is squared
+        static void mul_limbs(const uint64_t *, size_t, const uint64_t *, size_t, uint64_t *);
+
+        //q = a / b and r = a % b for magnitudes without leading zeros
+        //normalized long division (knuth's algorithm d)
+        static void div_limbs(const limb_vector &, const limb_vector &, limb_vector &, limb_vector &);
+
+        //divisors and quotients at least this long (in limbs) are divided by newton's method
+        static constexpr size_t newton_threshold_ = 2000;
+
+        //multiply by base^k if k > 0, divide by base^(-k) truncating if k < 0
+        BigInt shift_limbs(long long int) const;
+
+        //multiply two magnitudes, result is not normalized
+        static limb_vector multiply(const limb_vector &, const limb_vector &);
+
+        //absolute value of a native integer
+        template <typename T>
+        static uint64_t magnitude(T);
+
+        //this += b[0, nb) with the given sign, in place
+        //b may be the limbs of this
+        void add_signed(const uint64_t *, size_t, bool);
+
+        //this += a * b, negated if the flag is set
+        //short operands are accumulated by addmul/submul without a product temporary
+        //neither operand may be this
+        void add_product(const BigInt &, const BigInt &, bool);
+
+        //operands at least this long (in limbs) are reduced by half-gcd, shorter ones by lehmer steps
+        static constexpr size_t half_gcd_threshold_ = 100;
+
+        //rows of euclid's algorithm with cofactors
+        struct euclid_state;
+
+        //bits [shift, shift + 124) of the magnitude
+        unsigned __int128 top_bits(size_t) const;
+
+        //cofactors t of the euclid steps on a >= b >= 0 that the leading 124 bits of a determine
+        //(a', b') = (t[0] * a + t[1] * b, t[2] * a + t[3] * b), the identity if no step is certain
+        //stops once b' has at most stop bits
+        static void lehmer_matrix(const BigInt &, const BigInt &, size_t, int64_t (&)[4]);
+
+        //out[0, na + 1) = |s * a[0, na) + t * b[0, nb)| for nb <= na, returns true if it is negative
+        static bool combine_limbs(const uint64_t *, size_t, const uint64_t *, size_t, int64_t, int64_t, uint64_t *);
+
+        //apply a step matrix to the rows and the cofactors
+        static void transform(euclid_state &, const int64_t (&)[4]);
+        static void transform(euclid_state &, const BigInt (&)[2][2]);
+
+        //one step of euclid's algorithm by a full division
+        static void division_step(euclid_state &);
+
+        //matrix m that reduces a >= b >= 0 of n bits to the consecutive remainders around n / 2 + 1 bits
+        //recursion on the leading halves, lehmer steps below half_gcd_threshold_
+        static void half_gcd(const BigInt &, const BigInt &, BigInt (&)[2][2]);
+
+        //run euclid's algorithm until b is zero
+        static void euclid(euclid_state &);
+
+        //true if the odd x > 1 is a p-th power for an odd prime p
+        //cheap tests modulo 2^64 and small primes reject most candidates before an exact root
+        static bool is_odd_power(const BigInt &, uint64_t);
+
+        //primes up to n in increasing order, sieve of eratosthenes on the odd numbers
+        static std::vector<uint64_t> primes_up_to(uint64_t);
+
+        //f[0] * ... * f[n - 1] by a balanced product tree, leaves pack factors into single limbs
+        static BigInt product_tree(const uint64_t *, size_t);
+
+        //product of p[i]^e[i], squares of the products of the primes with each exponent bit set
+        //from the highest bit down, so every big product is a square or between similar sizes
+        static BigInt from_prime_powers(const std::vector<uint64_t> &, const std::vector<uint64_t> &);
+
+        //ranges of at least this many limbs in total are split across worker threads
+        //sums are bound by memory and need far longer ranges than products to gain from threads
+        static constexpr size_t parallel_sum_threshold_ = 1 << 20;
+        static constexpr size_t parallel_product_threshold_ = 1 << 12;
+
+        //sum of n values from first in one two's complement buffer
+        //every value is added or subtracted without carry propagation, the carries out of each limb
+        //are counted and propagated once at the end
+        template <typename Iterator>
+        static BigInt sum_range(Iterator, size_t);
+
+        //product of n values from first by a balanced binary tree, the halves of the
+        //top levels are forked on the thread pool while there are threads left
+        template <typename Iterator>
+        static BigInt product_range(Iterator, size_t, size_t);
+
+        //in-place arithmetic with a native integer given by its magnitude and sign
+        //one pass over the limbs, no temporary BigInt
+        void add_small(uint64_t, bool);
+        void mul_small(uint64_t, bool);
+
+        //divide in place, returns the remainder of the magnitudes
+        //throw exception if value is zero
+        uint64_t div_small(uint64_t, bool);
+
+        //compare with a native integer, returns -1, 0 or 1
+        int compare_small(uint64_t, bool) const;
 
     public:
         //exceptions
@@ -57,6 +431,62 @@ class BigInt {
                 }
         };
 
+        //precomputed reciprocal of a divisor
+        class reciprocal;
+
+        //precomputed montgomery constants of an odd modulus
+        class montgomery;
+
+        //ModInt keeps its montgomery form in a limb_vector
+        friend class ModInt;
+
+        //number of threads that work on one long multiplication or division, the calling thread included
+        //1, the default, keeps all work on the calling thread, 0 selects the number of hardware threads
+        //results are the same for every thread count
+        //must not be changed while other threads use BigInt
+        static void set_threads(size_t);
+        static size_t threads();
+
+        //lazy expressions, opt-in through BigInt::lazy()
+        //BigInt::lazy(a) * b + BigInt::lazy(c) * d - e builds an expression tree instead of temporaries
+        //it is evaluated once, when it is assigned to a BigInt
+        //operands are held by reference and must outlive the expression
+        class lazy_leaf;
+
+        template <typename L, typename R>
+        class lazy_sum;
+
+        template <typename L, typename R>
+        class lazy_product;
+
+        //flattened expression: a signed sum of operands and products of two operands
+        class lazy_terms;
+
+        //true for the lazy expression types
+        template <typename T>
+        struct is_lazy;
+
+        //lazy_leaf for BigInt, the type itself for expressions
+        template <typename T>
+        struct lazy_node;
+
+        //true if operator+, - or * with these operands builds a lazy expression
+        template <typename L, typename R>
+        using lazy_operands = std::integral_constant<bool,
+            (BigInt::is_lazy<L>::value || BigInt::is_lazy<R>::value)
+            && (BigInt::is_lazy<L>::value || std::is_same<L, BigInt>::value)
+            && (BigInt::is_lazy<R>::value || std::is_same<R, BigInt>::value)>;
+
+        //start a lazy expression
+        static lazy_leaf lazy(const BigInt &);
+
+        //evaluate a lazy expression
+        template <typename E, typename = typename std::enable_if<BigInt::is_lazy<E>::value>::type>
+        BigInt(const E &);
+
+        template <typename E, typename = typename std::enable_if<BigInt::is_lazy<E>::value>::type>
+        BigInt & operator=(const E &);
+
         //default constructor
         //set up BigInt value as zero
         BigInt();
@@ -67,19 +497,47 @@ class BigInt {
 
         //constructor
         //set up BigInt value as given number in string format
+        //an empty string is zero
         //throw exception if string is invalid
-        BigInt(std::string);
+        BigInt(const std::string &);
+        BigInt(std::string_view);
+        BigInt(const char *);
+
+        //the same for the characters [first, last), parsed in place
+        BigInt(const char *, const char *);
         
         //copy constructor
         //set up BigInt value as given BigInt value
         BigInt(const BigInt &);
 
+        //move constructor
+        //takes the limbs of the given BigInt, which is left equal to zero
+        BigInt(BigInt &&) noexcept;
+
         //send number to stream
         friend std::ostream & operator<<(std::ostream &, const BigInt &);
 
+        //read number from stream: optional '-' and decimal digits
+        //digits are parsed in fixed blocks as they arrive, the token is never buffered whole
+        //set failbit and keep the value if there are no digits
+        friend std::istream & operator>>(std::istream &, BigInt &);
+
+        //parse an optional '-' and the longest run of decimal digits at the start of [first, last)
+        //on success ptr points past the last digit
+        //without digits ec is std::errc::invalid_argument, ptr is first and value is unchanged
+        friend std::from_chars_result from_chars(const char *, const char *, BigInt &);
+
         //convert BigInt to string
         operator std::string() const;
 
+        //write the decimal representation into str, reusing its buffer
+        void to_string(std::string &) const;
+
+        //write the decimal representation into [first, last) without allocating the text
+        //on success ptr points past the last character
+        //if it does not fit, ec is std::errc::value_too_large and ptr is last
+        friend std::to_chars_result to_chars(char *, char *, const BigInt &);
+
         //returns the number of digits
         size_t size() const;
 
@@ -90,6 +548,10 @@ class BigInt {
         //copy the given number
         BigInt & operator=(const BigInt &);
 
+        //move assignment
+        //takes the limbs of the given BigInt, which is left equal to zero
+        BigInt & operator=(BigInt &&) noexcept;
+
         //unary plus
         //returns the number
         BigInt operator+() const;
@@ -112,19 +574,104 @@ class BigInt {
 
         //addition
         friend BigInt operator+(const BigInt &, const BigInt &);
+
+        //addition reusing the limbs of a temporary operand
+        friend BigInt operator+(BigInt &&, const BigInt &);
+        friend BigInt operator+(const BigInt &, BigInt &&);
+        friend BigInt operator+(BigInt &&, BigInt &&);
         
         //subtraction
         friend BigInt operator-(const BigInt &, const BigInt &);
 
+        //subtraction reusing the limbs of a temporary operand
+        friend BigInt operator-(BigInt &&, const BigInt &);
+        friend BigInt operator-(const BigInt &, BigInt &&);
+        friend BigInt operator-(BigInt &&, BigInt &&);
+
         //multiplication
+        //x * x is computed as square(x)
         friend BigInt operator*(const BigInt &, const BigInt &); 
 
+        //x * x with the squaring kernels, about half the limb products of a general multiplication
+        friend BigInt square(const BigInt &);
+
+        //base^exp by left-to-right sliding-window exponentiation, pow(x, 0) = 1
+        //the result is built in one buffer sized up front
+        //throw exception if the result does not fit in memory addressing
+        friend BigInt pow(const BigInt &, uint64_t);
+
+        //base^exp modulo |mod| in [0, |mod|)
+        //odd moduli use montgomery multiplication, the context of the last modulus is kept per thread
+        //throw exception if mod is zero or exp is negative
+        friend BigInt powmod(const BigInt &, const BigInt &, const BigInt &);
+
+        //greatest common divisor, non-negative, gcd(0, 0) = 0
+        //lehmer's algorithm on double-word leading parts, half-gcd for long operands
+        friend BigInt gcd(const BigInt &, const BigInt &);
+
+        //(g, x, y) with g = gcd(a, b) and a * x + b * y = g
+        friend std::tuple<BigInt, BigInt, BigInt> xgcd(const BigInt &, const BigInt &);
+
+        //x in [0, |m|) with a * x = 1 modulo m
+        //throw exception if m is zero or a and m are not coprime
+        friend BigInt modinv(const BigInt &, const BigInt &);
+
+        //(s, r) with s = floor(sqrt(x)) and r = x - s^2
+        //newton's iteration on the leading half of the bits doubles the precision per level
+        //throw exception if x is negative
+        friend std::pair<BigInt, BigInt> sqrtrem(const BigInt &);
+
+        //floor(sqrt(x))
+        //throw exception if x is negative
+        friend BigInt isqrt(const BigInt &);
+
+        //n-th root of x truncated toward zero
+        //throw exception if n is zero or n is even and x is negative
+        friend BigInt iroot(const BigInt &, uint64_t);
+
+        //true if x = y^k for some integers y and k >= 2
+        friend bool is_perfect_power(const BigInt &);
+
+        //n! from the prime factorization by legendre's formula
+        friend BigInt factorial(uint64_t);
+
+        //n choose k, zero if k > n
+        //the prime factorization by kummer's theorem, a product over the numerator for small k
+        friend BigInt binomial(uint64_t, uint64_t);
+
+        //product of the primes up to n
+        friend BigInt primorial(uint64_t);
+
+        //sum of the values in [first, last) given by forward iterators, sum of an empty range is zero
+        //the range is walked more than once, single-pass input iterators do not compile
+        //one buffer sized up front for the whole range, one carry propagation
+        //long ranges are split into the given number of chunks, BigInt::threads() by default
+        //the chunks run on the threads of set_threads, never on more
+        template <typename Iterator>
+        friend BigInt sum(Iterator, Iterator);
+        template <typename Iterator>
+        friend BigInt sum(Iterator, Iterator, size_t);
+
+        //product of the values in [first, last) given by forward iterators, product of an empty range is one
+        //the range is walked more than once, single-pass input iterators do not compile
+        //a balanced binary tree multiplies operands of similar length
+        //long ranges fork subtrees for up to the given number of threads, BigInt::threads() by default
+        //the subtrees run on the threads of set_threads, never on more
+        template <typename Iterator>
+        friend BigInt product(Iterator, Iterator);
+        template <typename Iterator>
+        friend BigInt product(Iterator, Iterator, size_t);
+
         //division
         friend BigInt operator/(const BigInt &, const BigInt &);
 
         //modulo
         friend BigInt operator%(const BigInt &, const BigInt &);
 
+        //quotient and remainder from one division
+        //the same values as operator/ and operator%
+        friend std::pair<BigInt, BigInt> divmod(const BigInt &, const BigInt &);
+
         //equality comparison operator
         bool operator==(const BigInt &) const;
 
@@ -155,6 +702,17 @@ class BigInt {
         //bitwise OR
         friend BigInt operator|(const BigInt &, const BigInt &);
 
+        //left shift, multiplies by 2^shift
+        //templates on the native shift type, so a << 3 does not compete with int << int through operator int
+        //throw exception if shift is negative
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator<<(T) const;
+
+        //arithmetic right shift, rounds toward negative infinity like native integers
+        //throw exception if shift is negative
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator>>(T) const;
+
         //addition assignment
         BigInt & operator+=(const BigInt &);
 
@@ -178,345 +736,3533 @@ class BigInt {
 
         //bitwise OR assignment
         BigInt & operator|=(const BigInt &);
-};
 
-        BigInt::BigInt() {
-            this->isNegative_ = false;
-            this->digits_.push_back(0);
-        }
+        //left shift assignment
+        BigInt & operator<<=(size_t);
 
-        BigInt::BigInt(int num) {
-            if (num == 0) {
-                BigInt();
-            }
-            else {
-                if (num > 0) {
-                    this->isNegative_ = false;
-                }
-                if (num < 0) {
-                    this->isNegative_ = true;
-                    num = -num;
-                }
-                do {
-                    int reminder = num % BigInt::base_; 
-                    this->digits_.push_back(reminder);
-                    num /= BigInt::base_;
-                } while (num != 0);
-            }
-        }
+        //right shift assignment
+        BigInt & operator>>=(size_t);
 
-        void BigInt::check_string(std::string str) {
-            std::string tmp;
-            if (str[0] == '-') {
-                str = str.substr(1);
-            }
-            for (long long int i = 0; i < str.size(); i++) {
-                if (str[i] < '0' || str[i] > '9') {
-                    throw BigInt::invalid_argument();
-                }
-            }
-        }
+        //arithmetic and comparisons with native integers
+        //work on the limbs directly instead of converting the integer to BigInt
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt & operator+=(T);
 
-        void BigInt::remove_leading_zeros() {
-            while (this->digits_.size() > 1 && this->digits_.back() == 0) {
-                this->digits_.pop_back();
-            }
-            if (this->digits_.size() == 1 && this->digits_[0] == 0) {
-                this->isNegative_ = false;
-            }
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt & operator-=(T);
 
-        BigInt::BigInt(std::string str) {
-            if (str.length() == 0) {
-                BigInt();
-            }
-            else {
-                this->check_string(str);
-                if (str[0] == '-') {
-                    this->isNegative_ = true;
-                    str = str.substr(1);
-                }
-                else {
-                    this->isNegative_ = false;
-                }
-                for (long long int i = str.size(); i > 0; i -= 9) {
-                    if (i < 9)
-                        this->digits_.push_back(atoi(str.substr(0, i).c_str()));
-                    else
-                        this->digits_.push_back(atoi(str.substr(i - 9, 9).c_str()));
-                }
-            }
-            this->remove_leading_zeros();
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt & operator*=(T);
 
-        BigInt::BigInt(const BigInt & big_int) {
-            this->isNegative_ = big_int.isNegative_;
-            this->digits_ = big_int.digits_;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt & operator/=(T);
 
-        std::ostream & operator<<(std::ostream & ostream, const BigInt & big_int) {
-            if (big_int.digits_.empty()) {
-                ostream << 0;
-            }
-            if (big_int.isNegative_ == true) {
-                ostream << '-';
-            }
-            ostream << big_int.digits_.back();
-            char fill = ostream.fill('0');
-            for (long long int i = big_int.digits_.size() - 2; i >= 0; i--) {
-                ostream << std::setw(9) << big_int.digits_[i];
-                ostream.fill(fill);
-            }
-            return ostream;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt & operator%=(T);
 
-        BigInt::operator std::string() const {
-            std::stringstream s;
-            s << *this;
-            return s.str();
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator==(T) const;
 
-        size_t BigInt::size() const {
-            BigInt tmp = *this;
-            if (tmp == (BigInt)0) return 1;
-            size_t size = 0;
-            while (tmp / (BigInt)10 != (BigInt)0) {
-                size++;
-                tmp /= 10;
-            }
-            return size;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator!=(T) const;
 
-        BigInt::operator int() const {
-            int result = this->digits_[0];
-            if (this->digits_.size() > 2) {
-                throw BigInt::out_of_bound();
-            }
-            else if (this->digits_.size() == 2 && this->digits_[1] > 2) {
-                throw BigInt::out_of_bound();
-            }
-            
-            if (this->digits_.size() == 2) {
-                result += this->digits_[1] * BigInt::base_;
-            }
-            if (this->isNegative_ == true) {
-                result = -result;
-            }
-            return result;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator<(T) const;
 
-        BigInt & BigInt::operator=(const BigInt & big_int) {
-            this->isNegative_ = big_int.isNegative_;
-            this->digits_ = big_int.digits_;
-            return *this;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator>(T) const;
 
-        BigInt BigInt::operator+() const {
-            BigInt tmp(*this);
-            return tmp;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator<=(T) const;
 
-        BigInt BigInt::operator-() const {
-            BigInt tmp(*this);
-            tmp.isNegative_ = !tmp.isNegative_;
-            return tmp;
-        }
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator>=(T) const;
 
-        BigInt & BigInt::operator++() {
-            return *this = *this + (BigInt)1;
-        }
+    private:
+        //reciprocal of decimal_power(k), computed once and shared by all conversions
+        static const reciprocal & decimal_reciprocal(size_t);
+};
 
-        const BigInt BigInt::operator++(int) {
-            BigInt tmp = *this;
-            *this = *this + (BigInt)1;
-            return tmp;
-        }
+//divides many numbers by the same divisor using multiplications only
+//the reciprocal is computed once by newton's iteration
+//every step needs the result of the one before, so only the multiplications inside a step use the threads of set_threads
+class BigInt::reciprocal {
+    private:
+        //absolute value of the divisor
+        BigInt divisor_;
 
-        BigInt & BigInt::operator--() {
-            return *this = *this - (BigInt)1;
-        }
+        //true if the divisor is negative
+        bool isNegative_;
 
-        const BigInt BigInt::operator--(int) {
-            BigInt tmp = *this;
-            *this = *this - (BigInt)1;
-            return tmp;
-        }
+        //floor(base^(2n) / divisor_), n is the number of divisor limbs
+        BigInt inverse_;
 
-        BigInt operator+(const BigInt & first, const BigInt & second) {
-            //(-a) + (b) --> (b) - (a)
-            if (first.isNegative_ == true && second.isNegative_ == false) {
-                return second - (-first);
-            }
-            //a + (-b) --> a - (b)
-            else if (second.isNegative_ == true && first.isNegative_ == false) {
-                return first - (-second);
-            }
-            else {
-                BigInt result;
-                long long int min_size, max_size;
-                BigInt mmax;
-                if (first > second) {
-                    min_size = second.digits_.size(), max_size = first.digits_.size();
-                    mmax = first;
-                }
-                else {
-                    max_size = second.digits_.size(), min_size = first.digits_.size();
-                    mmax = second;
-                }
-                result = mmax;
-                int reminder = 0;
-                for (long long int i = 0; i < std::min(first.digits_.size(), second.digits_.size()); i++) {
-                    long long int add_result = first.digits_[i] + second.digits_[i];
-                    if ((add_result + reminder) >= BigInt::base_) {
-                        result.digits_[i] = (add_result + reminder) % BigInt::base_;
-                        reminder = (add_result + reminder) / BigInt::base_;
-                    }
-                    else {
-                        result.digits_[i] = add_result + reminder;
-                        reminder = 0;
-                    }
-                }
-                if (first.isNegative_ == true && second.isNegative_ == true) {
-                    result.isNegative_ = true;
-                }
-                else if (first.isNegative_ == false && second.isNegative_ == false) {
-                    result.isNegative_ = false;
-                }
+        //floor(base^(2n) / b) for positive b of n limbs
+        static BigInt inverse(const BigInt &);
+
+        //q = a / divisor_ and r = a % divisor_ for non-negative a
+        void divide_magnitude(const BigInt &, BigInt &, BigInt &) const;
+
+    public:
+        //constructor
+        //throw exception if divisor is zero
+        reciprocal(const BigInt &);
+
+        //absolute value of the divisor
+        const BigInt & divisor() const;
+
+        //quotient, the same as dividend / divisor
+        BigInt quotient(const BigInt &) const;
+
+        //non-negative remainder of dividend / divisor
+        BigInt remainder(const BigInt &) const;
+
+        //quotient and remainder from one division
+        std::pair<BigInt, BigInt> divmod(const BigInt &) const;
+};
+
+//modular multiplication by an odd modulus without division
+//a value x is kept in montgomery form x * base^n mod modulus as n limbs, n is the number of modulus limbs
+class BigInt::montgomery {
+    private:
+        BigInt modulus_;
+
+        //-modulus^(-1) mod base
+        uint64_t inverse_;
+
+        //base^(2n) mod modulus, converts into montgomery form
+        limb_vector r2_;
+
+        //base^n mod modulus, montgomery form of one
+        limb_vector one_;
+
+    public:
+        //constructor
+        //throw exception if the modulus is not positive and odd
+        montgomery(const BigInt &);
+
+        const BigInt & modulus() const;
+
+        //number of limbs of the modulus and of values in montgomery form
+        size_t size() const;
+
+        //res[0, n) = t[0, 2n) / base^n mod modulus for t < modulus * base^n
+        //t has room for 2n + 1 limbs and is overwritten
+        void reduce(uint64_t *, uint64_t *) const;
+
+        //res[0, n) = a * b / base^n mod modulus, the montgomery product
+        //res may be a or b, the scratch buffer is kept per thread
+        void multiply(const uint64_t *, const uint64_t *, uint64_t *) const;
+
+        //res[0, n) = a + b mod modulus and a - b mod modulus, res may be a or b
+        void add(const uint64_t *, const uint64_t *, uint64_t *) const;
+        void subtract(const uint64_t *, const uint64_t *, uint64_t *) const;
+
+        //res[0, n) = -a mod modulus, res may be a
+        void negate(const uint64_t *, uint64_t *) const;
+
+        //res[0, n) = montgomery form of x mod modulus, any sign
+        void to_montgomery(const BigInt &, uint64_t *) const;
+
+        //value of a[0, n) in montgomery form
+        BigInt from_montgomery(const uint64_t *) const;
+
+        //montgomery form of one
+        const uint64_t * one() const;
+
+        //res[0, n) = a^exp in montgomery form for exp >= 0, res may be a
+        //fixed window exponent scanning over a table of 2^window powers
+        void pow(const uint64_t *, const BigInt &, uint64_t *) const;
+};
+
+//a >= b >= 0, the current pair of euclid's algorithm
+//every row operation on (a, b) is repeated on the rows of u[][0, columns)
+struct BigInt::euclid_state {
+    BigInt a;
+
+    BigInt b;
+
+    BigInt u[2][2];
+
+    size_t columns;
+};
+
+//fork-join pool for the sub-products of long multiplications
+//every thread owns a deque, it takes its own tasks from the back and steals from the front of the others
+//a thread that waits for a stolen task runs other tasks meanwhile, so nested forks cannot deadlock
+//it sleeps until a task finishes when there is nothing to run
+//threads outside the pool share the last queue, each of them takes its own task back from anywhere in it
+class BigInt::thread_pool {
+    private:
+        //a forked function, lives in the stack frame of the forking thread
+        struct task {
+            void (*run)(void *);
+
+            void * function;
+
+            std::exception_ptr error;
+
+            std::atomic<bool> done;
+        };
+
+        struct queue {
+            std::mutex mutex;
+
+            std::deque<task *> tasks;
+        };
+
+        //one queue per worker and a last one shared by the threads outside the pool
+        std::vector<std::unique_ptr<queue>> queues_;
+
+        std::vector<std::thread> workers_;
+
+        std::atomic<bool> stop_;
+
+        //tasks in all queues, idle workers sleep while it is zero
+        std::atomic<size_t> queued_;
+
+        std::mutex sleep_mutex_;
+
+        std::condition_variable wake_;
+
+        //signalled whenever a stolen task is done, wakes the threads that wait for one
+        std::condition_variable finished_;
+
+        thread_pool();
+
+        //queue of the current thread, SIZE_MAX outside the pool
+        static size_t & current();
+
+        //run a task from the own queue or stolen from another one
+        //returns false if all queues are empty
+        bool run_one(size_t);
+
+        //main loop of a worker
+        void work(size_t);
+
+        //join all workers
+        void stop();
+
+    public:
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool & operator=(const thread_pool &) = delete;
+
+        ~thread_pool();
+
+        //the pool of the process, without workers until it is resized
+        static thread_pool & instance();
+
+        //threads - 1 workers, the forking thread is the last one
+        void resize(size_t);
+
+        //number of threads, the forking one included
+        size_t size() const;
+
+        //run first on this thread while second may be stolen, returns once both have finished
+        //the exception of first, else the one of second, is rethrown
+        template <typename F, typename G>
+        void fork(F &&, G &&);
+
+        //run all functions, possibly in parallel
+        template <typename F, typename... Rest>
+        void invoke(F &&, Rest &&...);
+
+        //body(lo, hi) on pieces of [begin, end) no longer than grain, possibly in parallel
+        template <typename F>
+        void for_range(size_t, size_t, size_t, F &&);
+};
+
+class BigInt::lazy_terms {
+    private:
+        struct term {
+            const BigInt * left;
+
+            //nullptr for a single operand
+            const BigInt * right;
+
+            bool negative;
+        };
+
+        std::vector<term> terms_;
+
+        //values of subexpressions used as factors
+        //a list does not allocate until it is used and keeps references valid
+        std::list<BigInt> temporaries_;
+
+    public:
+        //room for the given number of terms
+        explicit lazy_terms(size_t);
+
+        //add left * right, or left alone if right is nullptr
+        void add(const BigInt *, const BigInt *, bool);
+
+        //storage for a subexpression that lives as long as the terms
+        BigInt & temporary();
+
+        //true if the value is one of the operands
+        bool refers_to(const BigInt *) const;
+
+        //value = sum of the terms, the destination is sized once
+        //value must not be one of the operands
+        void evaluate(BigInt &) const;
+};
+
+class BigInt::lazy_leaf {
+    private:
+        const BigInt * value_;
+
+    public:
+        //number of terms after flattening
+        static constexpr size_t term_count = 1;
+
+        explicit lazy_leaf(const BigInt &);
+
+        //add the expression to the terms, negated if the flag is set
+        void collect(BigInt::lazy_terms &, bool) const;
+
+        //value of the expression
+        const BigInt & materialize(BigInt::lazy_terms &) const;
+};
+
+//left + right, or left - right
+template <typename L, typename R>
+class BigInt::lazy_sum {
+    private:
+        L left_;
+
+        R right_;
+
+        bool subtract_;
+
+    public:
+        static constexpr size_t term_count = L::term_count + R::term_count;
+
+        lazy_sum(const L &, const R &, bool);
+
+        void collect(BigInt::lazy_terms &, bool) const;
+
+        const BigInt & materialize(BigInt::lazy_terms &) const;
+};
+
+//left * right
+template <typename L, typename R>
+class BigInt::lazy_product {
+    private:
+        L left_;
+
+        R right_;
+
+    public:
+        static constexpr size_t term_count = 1;
+
+        lazy_product(const L &, const R &);
+
+        void collect(BigInt::lazy_terms &, bool) const;
+
+        const BigInt & materialize(BigInt::lazy_terms &) const;
+};
+
+template <typename T>
+struct BigInt::is_lazy : std::false_type {};
+
+template <>
+struct BigInt::is_lazy<BigInt::lazy_leaf> : std::true_type {};
+
+template <typename L, typename R>
+struct BigInt::is_lazy<BigInt::lazy_sum<L, R>> : std::true_type {};
+
+template <typename L, typename R>
+struct BigInt::is_lazy<BigInt::lazy_product<L, R>> : std::true_type {};
+
+template <typename T>
+struct BigInt::lazy_node {
+    typedef T type;
+
+    static const T & wrap(const T & value) {
+        return value;
+    }
+};
+
+template <>
+struct BigInt::lazy_node<BigInt> {
+    typedef BigInt::lazy_leaf type;
+
+    static BigInt::lazy_leaf wrap(const BigInt & value) {
+        return BigInt::lazy_leaf(value);
+    }
+};
+
+class ModInt;
+
+//odd modulus shared by many ModInt values
+//the montgomery constants are computed once and shared by all values and copies of the context
+class ModContext {
+    private:
+        std::shared_ptr<const BigInt::montgomery> montgomery_;
+
+    public:
+        //constructor
+        //throw exception if the modulus is not positive and odd
+        explicit ModContext(const BigInt &);
+
+        const BigInt & modulus() const;
+
+        //x mod modulus as a value of this context, any sign
+        ModInt operator()(const BigInt &) const;
+
+        friend class ModInt;
+};
+
+//residue modulo the modulus of a ModContext
+//kept in montgomery form across operations, converted back only when the value is read
+//in-place operations reuse the limbs of the value, below montgomery_threshold_ limbs they allocate nothing
+//binary operations on temporaries work in place as well, copies of values up to four limbs stay inline
+class ModInt {
+    private:
+        //nullptr for a default constructed value
+        std::shared_ptr<const BigInt::montgomery> context_;
+
+        //montgomery form, as many limbs as the modulus
+        BigInt::limb_vector limbs_;
+
+        //throw exception if the values do not have the same modulus
+        void check_context(const ModInt &) const;
+
+    public:
+        //zero without a modulus, only assignment is allowed
+        ModInt();
+
+        //x mod the modulus of the context, any sign
+        ModInt(const ModContext &, const BigInt &);
+
+        //throw exception for a value without a modulus
+        const BigInt & modulus() const;
+
+        //value in [0, modulus), zero without a modulus
+        BigInt value() const;
+
+        explicit operator BigInt() const;
+
+        //in place, the operands must have the same modulus
+        //throw exception otherwise
+        ModInt & operator+=(const ModInt &);
+        ModInt & operator-=(const ModInt &);
+        ModInt & operator*=(const ModInt &);
+
+        friend ModInt operator+(const ModInt &, const ModInt &);
+        friend ModInt operator-(const ModInt &, const ModInt &);
+        friend ModInt operator*(const ModInt &, const ModInt &);
+
+        //temporary operands hold the result
+        friend ModInt operator+(ModInt &&, const ModInt &);
+        friend ModInt operator+(const ModInt &, ModInt &&);
+        friend ModInt operator+(ModInt &&, ModInt &&);
+        friend ModInt operator-(ModInt &&, const ModInt &);
+        friend ModInt operator-(const ModInt &, ModInt &&);
+        friend ModInt operator-(ModInt &&, ModInt &&);
+        friend ModInt operator*(ModInt &&, const ModInt &);
+        friend ModInt operator*(const ModInt &, ModInt &&);
+        friend ModInt operator*(ModInt &&, ModInt &&);
+
+        ModInt operator-() const &;
+        ModInt operator-() &&;
+
+        //this^exp
+        //throw exception if exp is negative
+        ModInt pow(const BigInt &) const;
+
+        //values are equal if they have the same modulus and residue
+        bool operator==(const ModInt &) const;
+        bool operator!=(const ModInt &) const;
+
+        friend std::ostream & operator<<(std::ostream &, const ModInt &);
+};
+
+        bool BigInt::limb_vector::on_heap() const {
+            return this->data_ != this->inline_;
+        }
+
+        BigInt::limb_vector::limb_vector() {
+            this->data_ = this->inline_;
+            this->size_ = 0;
+            this->capacity_ = inline_capacity_;
+        }
+
+        BigInt::limb_vector::limb_vector(size_t n, uint64_t value) : limb_vector() {
+            this->assign(n, value);
+        }
+
+        BigInt::limb_vector::limb_vector(const uint64_t * first, const uint64_t * last) : limb_vector() {
+            this->assign(first, last);
+        }
+
+        BigInt::limb_vector::limb_vector(const BigInt::limb_vector & other)
+            : limb_vector(other.begin(), other.end()) {
+        }
+
+        BigInt::limb_vector::limb_vector(BigInt::limb_vector && other) noexcept : limb_vector() {
+            if (other.on_heap() == true) {
+                //steal the heap block
+                this->data_ = other.data_;
+                this->capacity_ = other.capacity_;
+                other.data_ = other.inline_;
+                other.capacity_ = inline_capacity_;
+            }
+            else {
+                std::copy(other.inline_, other.inline_ + other.size_, this->inline_);
+            }
+            this->size_ = other.size_;
+            other.size_ = 0;
+        }
+
+        BigInt::limb_vector::~limb_vector() {
+            if (this->on_heap() == true) {
+                delete[] this->data_;
+            }
+        }
+
+        BigInt::limb_vector & BigInt::limb_vector::operator=(const BigInt::limb_vector & other) {
+            if (this != &other) {
+                this->assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        BigInt::limb_vector & BigInt::limb_vector::operator=(BigInt::limb_vector && other) noexcept {
+            if (this != &other) {
+                if (other.on_heap() == true) {
+                    if (this->on_heap() == true) {
+                        delete[] this->data_;
+                    }
+                    this->data_ = other.data_;
+                    this->capacity_ = other.capacity_;
+                    other.data_ = other.inline_;
+                    other.capacity_ = inline_capacity_;
+                }
+                else {
+                    //fits whatever buffer this already has
+                    std::copy(other.inline_, other.inline_ + other.size_, this->data_);
+                }
+                this->size_ = other.size_;
+                other.size_ = 0;
+            }
+            return *this;
+        }
+
+        size_t BigInt::limb_vector::size() const {
+            return this->size_;
+        }
+
+        uint64_t * BigInt::limb_vector::data() {
+            return this->data_;
+        }
+
+        const uint64_t * BigInt::limb_vector::data() const {
+            return this->data_;
+        }
+
+        uint64_t * BigInt::limb_vector::begin() {
+            return this->data_;
+        }
+
+        const uint64_t * BigInt::limb_vector::begin() const {
+            return this->data_;
+        }
+
+        uint64_t * BigInt::limb_vector::end() {
+            return this->data_ + this->size_;
+        }
+
+        const uint64_t * BigInt::limb_vector::end() const {
+            return this->data_ + this->size_;
+        }
+
+        uint64_t & BigInt::limb_vector::operator[](size_t i) {
+            return this->data_[i];
+        }
+
+        const uint64_t & BigInt::limb_vector::operator[](size_t i) const {
+            return this->data_[i];
+        }
+
+        uint64_t & BigInt::limb_vector::back() {
+            return this->data_[this->size_ - 1];
+        }
+
+        const uint64_t & BigInt::limb_vector::back() const {
+            return this->data_[this->size_ - 1];
+        }
+
+        void BigInt::limb_vector::reserve(size_t n) {
+            if (n <= this->capacity_) {
+                return;
+            }
+            //grow geometrically so that push_back is amortized O(1)
+            size_t capacity = std::max(n, 2 * this->capacity_);
+            uint64_t * data = new uint64_t[capacity];
+            std::copy(this->begin(), this->end(), data);
+            if (this->on_heap() == true) {
+                delete[] this->data_;
+            }
+            this->data_ = data;
+            this->capacity_ = capacity;
+        }
+
+        void BigInt::limb_vector::resize(size_t n, uint64_t value) {
+            this->reserve(n);
+            if (n > this->size_) {
+                std::fill(this->data_ + this->size_, this->data_ + n, value);
+            }
+            this->size_ = n;
+        }
+
+        void BigInt::limb_vector::assign(size_t n, uint64_t value) {
+            this->size_ = 0;
+            this->resize(n, value);
+        }
+
+        void BigInt::limb_vector::assign(const uint64_t * first, const uint64_t * last) {
+            this->size_ = 0;
+            this->reserve(last - first);
+            std::copy(first, last, this->data_);
+            this->size_ = last - first;
+        }
+
+        void BigInt::limb_vector::push_back(uint64_t value) {
+            this->reserve(this->size_ + 1);
+            this->data_[this->size_++] = value;
+        }
+
+        void BigInt::limb_vector::pop_back() {
+            this->size_--;
+        }
+
+        void BigInt::limb_vector::insert(uint64_t * pos, size_t count, uint64_t value) {
+            size_t offset = pos - this->data_;
+            this->reserve(this->size_ + count);
+            std::copy_backward(this->data_ + offset, this->data_ + this->size_, this->data_ + this->size_ + count);
+            std::fill(this->data_ + offset, this->data_ + offset + count, value);
+            this->size_ += count;
+        }
+
+        void BigInt::limb_vector::erase(uint64_t * first, uint64_t * last) {
+            std::copy(last, this->end(), first);
+            this->size_ -= last - first;
+        }
+
+        void BigInt::limb_vector::swap(BigInt::limb_vector & other) {
+            BigInt::limb_vector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        template <typename L, typename R>
+        BigInt::lazy_sum<L, R>::lazy_sum(const L & left, const R & right, bool subtract)
+            : left_(left), right_(right), subtract_(subtract) {
+        }
+
+        template <typename L, typename R>
+        void BigInt::lazy_sum<L, R>::collect(BigInt::lazy_terms & terms, bool negative) const {
+            this->left_.collect(terms, negative);
+            this->right_.collect(terms, negative != this->subtract_);
+        }
+
+        template <typename L, typename R>
+        const BigInt & BigInt::lazy_sum<L, R>::materialize(BigInt::lazy_terms & terms) const {
+            BigInt::lazy_terms inner(term_count);
+            this->collect(inner, false);
+            BigInt & value = terms.temporary();
+            inner.evaluate(value);
+            return value;
+        }
+
+        template <typename L, typename R>
+        BigInt::lazy_product<L, R>::lazy_product(const L & left, const R & right)
+            : left_(left), right_(right) {
+        }
+
+        template <typename L, typename R>
+        void BigInt::lazy_product<L, R>::collect(BigInt::lazy_terms & terms, bool negative) const {
+            const BigInt & left = this->left_.materialize(terms);
+            const BigInt & right = this->right_.materialize(terms);
+            terms.add(&left, &right, negative);
+        }
+
+        template <typename L, typename R>
+        const BigInt & BigInt::lazy_product<L, R>::materialize(BigInt::lazy_terms & terms) const {
+            BigInt::lazy_terms inner(term_count);
+            this->collect(inner, false);
+            BigInt & value = terms.temporary();
+            inner.evaluate(value);
+            return value;
+        }
+
+        template <typename E, typename>
+        BigInt::BigInt(const E & expression) {
+            this->isNegative_ = false;
+            BigInt::lazy_terms terms(E::term_count);
+            expression.collect(terms, false);
+            terms.evaluate(*this);
+        }
+
+        template <typename E, typename>
+        BigInt & BigInt::operator=(const E & expression) {
+            BigInt::lazy_terms terms(E::term_count);
+            expression.collect(terms, false);
+            if (terms.refers_to(this) == true) {
+                //the old value is still needed while the new one is accumulated
+                BigInt value;
+                terms.evaluate(value);
+                return *this = std::move(value);
+            }
+            terms.evaluate(*this);
+            return *this;
+        }
+
+        //lazy operators, at least one operand is a lazy expression and the other one may be BigInt
+        template <typename L, typename R, typename = typename std::enable_if<BigInt::lazy_operands<L, R>::value>::type>
+        BigInt::lazy_sum<typename BigInt::lazy_node<L>::type, typename BigInt::lazy_node<R>::type>
+        operator+(const L & left, const R & right) {
+            return {BigInt::lazy_node<L>::wrap(left), BigInt::lazy_node<R>::wrap(right), false};
+        }
+
+        template <typename L, typename R, typename = typename std::enable_if<BigInt::lazy_operands<L, R>::value>::type>
+        BigInt::lazy_sum<typename BigInt::lazy_node<L>::type, typename BigInt::lazy_node<R>::type>
+        operator-(const L & left, const R & right) {
+            return {BigInt::lazy_node<L>::wrap(left), BigInt::lazy_node<R>::wrap(right), true};
+        }
+
+        template <typename L, typename R, typename = typename std::enable_if<BigInt::lazy_operands<L, R>::value>::type>
+        BigInt::lazy_product<typename BigInt::lazy_node<L>::type, typename BigInt::lazy_node<R>::type>
+        operator*(const L & left, const R & right) {
+            return {BigInt::lazy_node<L>::wrap(left), BigInt::lazy_node<R>::wrap(right)};
+        }
+
+        template <typename Sink>
+        void BigInt::to_decimal(const BigInt & x, size_t width, Sink & sink) {
+            if (x.digits_.size() <= BigInt::conversion_threshold_) {
+                //19-digit chunks from the lowest, written backwards
+                char buffer[(BigInt::conversion_threshold_ + 2) * 19];
+                char * end = buffer + sizeof(buffer), * p = end;
+                uint64_t limbs[BigInt::conversion_threshold_];
+                size_t n = x.digits_.size();
+                std::copy(x.digits_.begin(), x.digits_.end(), limbs);
+                do {
+                    p -= 19;
+                    BigInt::format_19(BigInt::div_limbs_small(limbs, n, 10'000'000'000'000'000'000ULL), p);
+                    while (n > 0 && limbs[n - 1] == 0) {
+                        n--;
+                    }
+                } while (n > 0);
+                //drop the leading zeros of the top chunk, keep one digit for zero
+                while (p < end - 1 && *p == '0') {
+                    p++;
+                }
+                size_t length = end - p;
+                size_t zeros = width > length ? width - length : 0;
+                //the padding comes from the free part of the buffer in front of the digits
+                std::fill(buffer, p, '0');
+                while (zeros > static_cast<size_t>(p - buffer)) {
+                    sink(static_cast<const char *>(buffer), p - buffer);
+                    zeros -= p - buffer;
+                }
+                sink(static_cast<const char *>(p - zeros), length + zeros);
+                return;
+            }
+
+            //split by the power of ten about half as long as x
+            size_t k = 0;
+            while (BigInt::decimal_power(k + 1).digits_.size() <= (x.digits_.size() + 1) / 2) {
+                k++;
+            }
+            size_t low = static_cast<size_t>(19) << k;
+            BigInt magnitude(x);
+            magnitude.isNegative_ = false;
+            std::pair<BigInt, BigInt> qr = BigInt::decimal_reciprocal(k).divmod(magnitude);
+            if (width == 0 && qr.first == 0) {
+                BigInt::to_decimal(qr.second, 0, sink);
+                return;
+            }
+            BigInt::to_decimal(qr.first, width == 0 ? 0 : width - low, sink);
+            BigInt::to_decimal(qr.second, low, sink);
+        }
+
+        template <typename Iterator>
+        BigInt BigInt::sum_range(Iterator first, size_t n) {
+            size_t length = 0;
+            Iterator it = first;
+            for (size_t i = 0; i < n; i++, ++it) {
+                const BigInt & x = *it;
+                length = std::max(length, x.digits_.size());
+            }
+            //n values of length limbs fit in length + 1 limbs, one more keeps the sign
+            BigInt::limb_vector limbs(length + 2, 0);
+            std::vector<int64_t> carries(length + 2, 0);
+            it = first;
+            for (size_t i = 0; i < n; i++, ++it) {
+                const BigInt & x = *it;
+                const uint64_t * d = x.digits_.data();
+                if (x.isNegative_ == false) {
+                    for (size_t j = 0; j < x.digits_.size(); j++) {
+                        uint64_t cur = limbs[j] + d[j];
+                        carries[j + 1] += cur < d[j];
+                        limbs[j] = cur;
+                    }
+                }
+                else {
+                    for (size_t j = 0; j < x.digits_.size(); j++) {
+                        carries[j + 1] -= limbs[j] < d[j];
+                        limbs[j] -= d[j];
+                    }
+                }
+            }
+            __int128 carry = 0;
+            for (size_t j = 0; j < limbs.size(); j++) {
+                carry += static_cast<__int128>(limbs[j]) + carries[j];
+                limbs[j] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+            return BigInt::from_twos_complement(limbs);
+        }
+
+        template <typename Iterator>
+        BigInt BigInt::product_range(Iterator first, size_t n, size_t threads) {
+            if (n == 0) {
+                return BigInt(1);
+            }
+            if (n == 1) {
+                return BigInt(*first);
+            }
+            Iterator middle = std::next(first, n / 2);
+            if (threads > 1) {
+                BigInt left, right;
+                BigInt::thread_pool::instance().invoke(
+                    [&] { left = BigInt::product_range(first, n / 2, threads / 2); },
+                    [&] { right = BigInt::product_range(middle, n - n / 2, threads - threads / 2); });
+                return left * right;
+            }
+            return BigInt::product_range(first, n / 2, 1) * BigInt::product_range(middle, n - n / 2, 1);
+        }
+
+        template <typename Iterator>
+        BigInt sum(Iterator first, Iterator last, size_t threads) {
+            static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+                          "sum needs forward iterators, the range is walked more than once");
+            size_t n = std::distance(first, last), limbs = 0;
+            if (threads > 1) {
+                for (Iterator it = first; it != last; ++it) {
+                    const BigInt & x = *it;
+                    limbs += x.digits_.size();
+                }
+            }
+            threads = std::min(threads, n);
+            if (threads <= 1 || limbs < BigInt::parallel_sum_threshold_) {
+                return BigInt::sum_range(first, n);
+            }
+            //chunks of about the same count, the partial sums are summed again
+            std::vector<BigInt> sums(threads);
+            BigInt::thread_pool::instance().for_range(0, threads, 1, [&](size_t lo, size_t hi) {
+                for (size_t t = lo; t < hi; t++) {
+                    size_t begin = n * t / threads, count = n * (t + 1) / threads - begin;
+                    sums[t] = BigInt::sum_range(std::next(first, begin), count);
+                }
+            });
+            return BigInt::sum_range(sums.begin(), sums.size());
+        }
+
+        template <typename Iterator>
+        BigInt sum(Iterator first, Iterator last) {
+            return sum(first, last, BigInt::threads());
+        }
+
+        template <typename Iterator>
+        BigInt product(Iterator first, Iterator last, size_t threads) {
+            static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>::value,
+                          "product needs forward iterators, the range is walked more than once");
+            size_t n = std::distance(first, last), limbs = 0;
+            if (threads > 1) {
+                for (Iterator it = first; it != last; ++it) {
+                    const BigInt & x = *it;
+                    limbs += x.digits_.size();
+                }
+            }
+            if (limbs < BigInt::parallel_product_threshold_) {
+                threads = 1;
+            }
+            return BigInt::product_range(first, n, threads);
+        }
+
+        template <typename Iterator>
+        BigInt product(Iterator first, Iterator last) {
+            return product(first, last, BigInt::threads());
+        }
+
+        template <typename T>
+        uint64_t BigInt::magnitude(T value) {
+            if (value < 0) {
+                return 0 - static_cast<uint64_t>(value);
+            }
+            return static_cast<uint64_t>(value);
+        }
+
+        template <typename Op>
+        BigInt BigInt::bitwise(const BigInt & first, const BigInt & second, Op op) {
+            //one extra limb keeps the sign of both operands
+            size_t n = std::max(first.digits_.size(), second.digits_.size()) + 1;
+            BigInt::limb_vector a = first.twos_complement(n);
+            BigInt::limb_vector b = second.twos_complement(n);
+            for (size_t i = 0; i < n; i++) {
+                a[i] = op(a[i], b[i]);
+            }
+            return BigInt::from_twos_complement(a);
+        }
+
+        template <typename T, typename>
+        BigInt & BigInt::operator+=(T value) {
+            this->add_small(BigInt::magnitude(value), value < 0);
+            return *this;
+        }
+
+        template <typename T, typename>
+        BigInt & BigInt::operator-=(T value) {
+            this->add_small(BigInt::magnitude(value), !(value < 0));
+            return *this;
+        }
+
+        template <typename T, typename>
+        BigInt & BigInt::operator*=(T value) {
+            this->mul_small(BigInt::magnitude(value), value < 0);
+            return *this;
+        }
+
+        template <typename T, typename>
+        BigInt & BigInt::operator/=(T value) {
+            this->div_small(BigInt::magnitude(value), value < 0);
+            return *this;
+        }
+
+        template <typename T, typename>
+        BigInt & BigInt::operator%=(T value) {
+            bool negative = this->isNegative_;
+            uint64_t divisor = BigInt::magnitude(value);
+            uint64_t remainder = this->div_small(divisor, false);
+            //the remainder is never negative, the same as operator%
+            if (negative == true && remainder != 0) {
+                remainder = divisor - remainder;
+            }
+            this->digits_.assign(1, 0);
+            this->isNegative_ = false;
+            this->add_small(remainder, false);
+            return *this;
+        }
+
+        template <typename T, typename>
+        bool BigInt::operator==(T value) const {
+            return this->compare_small(BigInt::magnitude(value), value < 0) == 0;
+        }
+
+        template <typename T, typename>
+        bool BigInt::operator!=(T value) const {
+            return this->compare_small(BigInt::magnitude(value), value < 0) != 0;
+        }
+
+        template <typename T, typename>
+        bool BigInt::operator<(T value) const {
+            return this->compare_small(BigInt::magnitude(value), value < 0) < 0;
+        }
+
+        template <typename T, typename>
+        bool BigInt::operator>(T value) const {
+            return this->compare_small(BigInt::magnitude(value), value < 0) > 0;
+        }
+
+        template <typename T, typename>
+        bool BigInt::operator<=(T value) const {
+            return this->compare_small(BigInt::magnitude(value), value < 0) <= 0;
+        }
+
+        template <typename T, typename>
+        bool BigInt::operator>=(T value) const {
+            return this->compare_small(BigInt::magnitude(value), value < 0) >= 0;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator+(const BigInt & first, T second) {
+            BigInt result(first);
+            result += second;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator+(T first, const BigInt & second) {
+            BigInt result(second);
+            result += first;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator-(const BigInt & first, T second) {
+            BigInt result(first);
+            result -= second;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator-(T first, const BigInt & second) {
+            BigInt result = -second;
+            result += first;
+            return result;
+        }
+
+        //temporaries with a native integer, these also keep (a + b) + 1 from matching operator+(BigInt &&, BigInt &&)
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator+(BigInt && first, T second) {
+            first += second;
+            return std::move(first);
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator+(T first, BigInt && second) {
+            second += first;
+            return std::move(second);
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator-(BigInt && first, T second) {
+            first -= second;
+            return std::move(first);
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator-(T first, BigInt && second) {
+            second -= first;
+            //negate in place, multiplying by -1 keeps zero non-negative
+            second *= -1;
+            return std::move(second);
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator*(const BigInt & first, T second) {
+            BigInt result(first);
+            result *= second;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator*(T first, const BigInt & second) {
+            BigInt result(second);
+            result *= first;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator/(const BigInt & first, T second) {
+            BigInt result(first);
+            result /= second;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        BigInt operator%(const BigInt & first, T second) {
+            BigInt result(first);
+            result %= second;
+            return result;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator==(T first, const BigInt & second) {
+            return second == first;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator!=(T first, const BigInt & second) {
+            return second != first;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator<(T first, const BigInt & second) {
+            return second > first;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator>(T first, const BigInt & second) {
+            return second < first;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator<=(T first, const BigInt & second) {
+            return second >= first;
+        }
+
+        template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+        bool operator>=(T first, const BigInt & second) {
+            return second <= first;
+        }
+
+        BigInt::BigInt() {
+            this->isNegative_ = false;
+            this->digits_.push_back(0);
+        }
+
+        BigInt::BigInt(int num) {
+            this->isNegative_ = num < 0;
+            this->digits_.push_back(BigInt::magnitude(num));
+        }
+
+        void BigInt::remove_leading_zeros() {
+            while (this->digits_.size() > 1 && this->digits_.back() == 0) {
+                this->digits_.pop_back();
+            }
+            if (this->digits_.size() == 1 && this->digits_[0] == 0) {
+                this->isNegative_ = false;
+            }
+        }
+
+        BigInt::BigInt(const std::string & str) : BigInt(str.data(), str.data() + str.size()) {
+        }
+
+        BigInt::BigInt(std::string_view str) : BigInt(str.data(), str.data() + str.size()) {
+        }
+
+        BigInt::BigInt(const char * str) : BigInt(std::string_view(str)) {
+        }
+
+        BigInt::BigInt(const char * first, const char * last) {
+            this->isNegative_ = false;
+            this->digits_.push_back(0);
+            if (first != last) {
+                std::from_chars_result result = from_chars(first, last, *this);
+                if (result.ec != std::errc() || result.ptr != last) {
+                    throw BigInt::invalid_argument();
+                }
+            }
+        }
+
+        std::from_chars_result from_chars(const char * first, const char * last, BigInt & value) {
+            const char * p = first;
+            bool negative = p != last && *p == '-';
+            if (negative == true) {
+                p++;
+            }
+            const char * digits = p;
+            p += BigInt::digit_run(p, last);
+            if (p == digits) {
+                return {first, std::errc::invalid_argument};
+            }
+            value = BigInt::from_decimal(digits, p);
+            value.isNegative_ = negative;
+            value.remove_leading_zeros();
+            return {p, std::errc()};
+        }
+
+        std::istream & operator>>(std::istream & istream, BigInt & big_int) {
+            std::istream::sentry sentry(istream);
+            if (!sentry) {
+                return istream;
+            }
+            std::streambuf * buffer = istream.rdbuf();
+            bool negative = false;
+            if (buffer->sgetc() == '-') {
+                negative = true;
+                buffer->sbumpc();
+            }
+
+            //blocks of 19 * 2^6 digits are merged like a binary counter
+            //two parts of equal length combine with a cached power of ten, so the work stays subquadratic
+            const size_t block_power = 6;
+            const size_t block = static_cast<size_t>(19) << block_power;
+            std::vector<std::pair<BigInt, size_t>> parts; //value and its power in the table
+            char digits[block];
+            size_t count = 0, total = 0;
+            int c = buffer->sgetc();
+            while (c != std::char_traits<char>::eof() && c >= '0' && c <= '9') {
+                digits[count++] = static_cast<char>(c);
+                c = buffer->snextc();
+                if (count == block) {
+                    BigInt value = BigInt::from_decimal(digits, digits + count);
+                    size_t power = block_power;
+                    while (parts.empty() == false && parts.back().second == power) {
+                        //the older part holds the higher digits
+                        parts.back().first *= BigInt::decimal_power(power);
+                        parts.back().first += value;
+                        value = std::move(parts.back().first);
+                        parts.pop_back();
+                        power++;
+                    }
+                    parts.emplace_back(std::move(value), power);
+                    total += count;
+                    count = 0;
+                }
+            }
+            total += count;
+            if (c == std::char_traits<char>::eof()) {
+                istream.setstate(std::ios_base::eofbit);
+            }
+            if (total == 0) {
+                istream.setstate(std::ios_base::failbit);
+                return istream;
+            }
+
+            //the parts have decreasing lengths, fold them from the highest digits
+            BigInt result;
+            for (size_t i = 0; i < parts.size(); i++) {
+                if (i > 0) {
+                    result *= BigInt::decimal_power(parts[i].second);
+                }
+                result += parts[i].first;
+            }
+            if (count > 0) {
+                result *= BigInt::power_of_ten(count);
+                result += BigInt::from_decimal(digits, digits + count);
+            }
+            result.isNegative_ = negative;
+            result.remove_leading_zeros();
+            big_int = std::move(result);
+            return istream;
+        }
+
+        const BigInt & BigInt::decimal_power(size_t k) {
+            //a deque keeps references valid while the table grows
+            static std::deque<BigInt> powers;
+            static std::mutex mutex;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (powers.empty() == true) {
+                powers.emplace_back();
+                powers.back().digits_[0] = 10'000'000'000'000'000'000ULL;
+            }
+            while (powers.size() <= k) {
+                powers.push_back(powers.back() * powers.back());
+            }
+            return powers[k];
+        }
+
+        const BigInt::reciprocal & BigInt::decimal_reciprocal(size_t k) {
+            static std::deque<BigInt::reciprocal> reciprocals;
+            static std::mutex mutex;
+            std::lock_guard<std::mutex> lock(mutex);
+            while (reciprocals.size() <= k) {
+                reciprocals.emplace_back(BigInt::decimal_power(reciprocals.size()));
+            }
+            return reciprocals[k];
+        }
+
+        BigInt BigInt::from_decimal(const char * first, const char * last) {
+            size_t length = last - first;
+            if (length <= BigInt::conversion_threshold_ * 19) {
+                //the leading length % 19 digits, then 19-digit chunks, each one fits a limb
+                size_t head = length % 19, count = length / 19;
+                uint64_t values[BigInt::conversion_threshold_];
+                BigInt::parse_19s(first + head, count, values);
+                BigInt result;
+                result.digits_.reserve(count + 1);
+                for (const char * q = first; q < first + head; q++) {
+                    result.digits_[0] = result.digits_[0] * 10 + (*q - '0');
+                }
+                for (size_t j = 0; j < count; j++) {
+                    //result = result * 10^19 + values[j] in one pass
+                    uint64_t carry = values[j];
+                    for (size_t i = 0; i < result.digits_.size(); i++) {
+                        unsigned __int128 cur = static_cast<unsigned __int128>(result.digits_[i]) * 10'000'000'000'000'000'000ULL + carry;
+                        result.digits_[i] = static_cast<uint64_t>(cur);
+                        carry = cur >> 64;
+                    }
+                    if (carry != 0) {
+                        result.digits_.push_back(carry);
+                    }
+                }
+                result.remove_leading_zeros();
+                return result;
+            }
+
+            //the low half takes the largest 19 * 2^k digits below the length
+            size_t k = 0;
+            while ((static_cast<size_t>(19) << (k + 1)) < length) {
+                k++;
+            }
+            const char * middle = last - (static_cast<size_t>(19) << k);
+            BigInt result = BigInt::from_decimal(first, middle);
+            result *= BigInt::decimal_power(k);
+            result += BigInt::from_decimal(middle, last);
+            return result;
+        }
+
+        size_t BigInt::digit_run(const char * first, const char * last) {
+#ifdef BIG_INT_SIMD
+            size_t head = std::min(static_cast<size_t>(last - first), BigInt::avx2_digit_threshold_);
+            size_t run = BigInt::digit_run_sse2(first, first + head);
+            if (run < head) {
+                return run;
+            }
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            if (avx2 == true) {
+                return run + BigInt::digit_run_avx2(first + run, last);
+            }
+            return run + BigInt::digit_run_sse2(first + run, last);
+#else
+            return BigInt::digit_run_scalar(first, last);
+#endif
+        }
+
+        size_t BigInt::digit_run_scalar(const char * first, const char * last) {
+            const char * p = first;
+            while (p != last && *p >= '0' && *p <= '9') {
+                p++;
+            }
+            return p - first;
+        }
+
+        uint64_t BigInt::parse_16(const char * p) {
+#ifdef BIG_INT_SIMD
+            static const bool sse41 = __builtin_cpu_supports("sse4.1");
+            if (sse41 == true) {
+                return BigInt::parse_16_sse41(p);
+            }
+#endif
+            return BigInt::parse_16_scalar(p);
+        }
+
+        void BigInt::parse_19s(const char * p, size_t count, uint64_t * out) {
+            size_t i = 0;
+#ifdef BIG_INT_SIMD
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            if (avx2 == true) {
+                i = BigInt::parse_19s_avx2(p, count, out);
+            }
+#endif
+            for (; i < count; i++) {
+                const char * q = p + 19 * i;
+                out[i] = BigInt::parse_16(q) * 1000 + (q[16] - '0') * 100 + (q[17] - '0') * 10 + (q[18] - '0');
+            }
+        }
+
+        uint64_t BigInt::parse_16_scalar(const char * p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            //swar: 8 digits per 64-bit word, pairs, then quads, then the whole word
+            uint64_t halves[2];
+            for (int h = 0; h < 2; h++) {
+                uint64_t v;
+                std::memcpy(&v, p + 8 * h, 8);
+                v -= 0x3030303030303030ULL;
+                v = v * 10 + (v >> 8);
+                halves[h] = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+                    + (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+            }
+            return halves[0] * 100'000'000 + halves[1];
+#else
+            uint64_t value = 0;
+            for (int i = 0; i < 16; i++) {
+                value = value * 10 + (p[i] - '0');
+            }
+            return value;
+#endif
+        }
+
+#ifdef BIG_INT_SIMD
+        size_t BigInt::digit_run_sse2(const char * first, const char * last) {
+            const char * p = first;
+            const __m128i zero = _mm_set1_epi8('0'), nine = _mm_set1_epi8(9);
+            while (last - p >= 16) {
+                //a byte is a digit if byte - '0' is at most 9 as unsigned
+                __m128i t = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), zero);
+                unsigned int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(t, nine), nine)) & 0xffff;
+                if (mask != 0) {
+                    return p - first + __builtin_ctz(mask);
+                }
+                p += 16;
+            }
+            return p - first + BigInt::digit_run_scalar(p, last);
+        }
+
+        uint64_t BigInt::parse_16_sse41(const char * p) {
+            __m128i t = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), _mm_set1_epi8('0'));
+            //pairs of digits, then 4 digits, then 8 digits per lane
+            t = _mm_maddubs_epi16(t, _mm_set_epi8(1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10));
+            t = _mm_madd_epi16(t, _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100));
+            t = _mm_packus_epi32(t, t);
+            t = _mm_madd_epi16(t, _mm_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000));
+            uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(t));
+            uint64_t low = static_cast<uint32_t>(_mm_extract_epi32(t, 1));
+            return high * 100'000'000 + low;
+        }
+
+        size_t BigInt::digit_run_avx2(const char * first, const char * last) {
+            const char * p = first;
+            const __m256i zero = _mm256_set1_epi8('0'), nine = _mm256_set1_epi8(9);
+            while (last - p >= 32) {
+                __m256i t = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), zero);
+                unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(t, nine), nine)));
+                if (mask != 0) {
+                    return p - first + __builtin_ctz(mask);
+                }
+                p += 32;
+            }
+            return p - first + BigInt::digit_run_scalar(p, last);
+        }
+
+        size_t BigInt::parse_19s_avx2(const char * p, size_t count, uint64_t * out) {
+            const __m256i zero = _mm256_set1_epi8('0');
+            const __m256i tens = _mm256_set_epi8(1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10,
+                                                 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10);
+            const __m256i hundreds = _mm256_set_epi16(1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100);
+            const __m256i ten_thousands = _mm256_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000,
+                                                           1, 10000, 1, 10000, 1, 10000, 1, 10000);
+            size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                const char * q = p + 19 * i;
+                //the leading 16 digits of chunk i in the low lane, of chunk i + 1 in the high lane
+                __m256i t = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(q))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + 19)), 1);
+                t = _mm256_sub_epi8(t, zero);
+                //the same reduction as parse_16_sse41 in each lane
+                t = _mm256_maddubs_epi16(t, tens);
+                t = _mm256_madd_epi16(t, hundreds);
+                t = _mm256_packus_epi32(t, t);
+                t = _mm256_madd_epi16(t, ten_thousands);
+                alignas(32) uint32_t halves[8];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(halves), t);
+                for (int lane = 0; lane < 2; lane++) {
+                    const char * tail = q + 19 * lane + 16;
+                    uint64_t head = halves[4 * lane] * 100'000'000ULL + halves[4 * lane + 1];
+                    out[i + lane] = head * 1000 + (tail[0] - '0') * 100 + (tail[1] - '0') * 10 + (tail[2] - '0');
+                }
+            }
+            return i;
+        }
+#endif
+
+        void BigInt::format_19(uint64_t value, char * out) {
+            static const char pairs[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+            for (int i = 17; i > 0; i -= 2) {
+                std::memcpy(out + i, pairs + 2 * (value % 100), 2);
+                value /= 100;
+            }
+            out[0] = '0' + value;
+        }
+
+        size_t BigInt::decimal_bound() const {
+            //log10(2) per bit, one digit for the rounding
+            return static_cast<size_t>(this->bit_length() * 0.30102999566398120) + 2;
+        }
+
+        std::to_chars_result to_chars(char * first, char * last, const BigInt & big_int) {
+            size_t space = last - first;
+            size_t sign = big_int.isNegative_ ? 1 : 0;
+            //the exact length is only needed when the bound does not fit
+            size_t length = big_int.decimal_bound();
+            if (sign + length > space) {
+                length = big_int.size();
+                if (sign + length > space) {
+                    return {last, std::errc::value_too_large};
+                }
+            }
+            if (sign == 1) {
+                *first++ = '-';
+            }
+            auto sink = [&first](const char * p, size_t n) {
+                std::memcpy(first, p, n);
+                first += n;
+            };
+            BigInt::to_decimal(big_int, 0, sink);
+            return {first, std::errc()};
+        }
+
+        void BigInt::to_string(std::string & str) const {
+            str.resize(this->decimal_bound() + 1);
+            std::to_chars_result result = to_chars(&str[0], &str[0] + str.size(), *this);
+            str.resize(result.ptr - str.data());
+        }
+
+        BigInt::BigInt(const BigInt & big_int) {
+            this->isNegative_ = big_int.isNegative_;
+            this->digits_ = big_int.digits_;
+        }
+
+        BigInt::BigInt(BigInt && big_int) noexcept : digits_(std::move(big_int.digits_)) {
+            this->isNegative_ = big_int.isNegative_;
+            big_int.digits_.assign(1, 0);
+            big_int.isNegative_ = false;
+        }
+
+        std::ostream & operator<<(std::ostream & ostream, const BigInt & big_int) {
+            //a field width needs the whole text for padding
+            if (ostream.width() != 0) {
+                return ostream << (std::string)big_int;
+            }
+            std::ostream::sentry sentry(ostream);
+            if (!sentry) {
+                return ostream;
+            }
+            //the digits go to the stream buffer in the pieces they are produced in
+            std::streambuf * buffer = ostream.rdbuf();
+            bool failed = big_int.isNegative_ == true && buffer->sputc('-') == std::char_traits<char>::eof();
+            auto sink = [buffer, &failed](const char * p, size_t n) {
+                if (failed == false && buffer->sputn(p, n) != static_cast<std::streamsize>(n)) {
+                    failed = true;
+                }
+            };
+            BigInt::to_decimal(big_int, 0, sink);
+            if (failed == true) {
+                ostream.setstate(std::ios_base::badbit);
+            }
+            return ostream;
+        }
+
+        BigInt::operator std::string() const {
+            std::string str;
+            this->to_string(str);
+            return str;
+        }
+
+        size_t BigInt::size() const {
+            size_t bits = this->bit_length();
+            if (bits <= 1) {
+                return 1;
+            }
+            //start from a lower bound, log10(|x|) >= (bits - 1) * log10(2)
+            size_t size = std::floor((bits - 1) * 0.30102999566398120);
+            size = size > 1 ? size - 1 : 1;
+            BigInt power = BigInt::power_of_ten(size);
+            while (BigInt::compare_limbs(this->digits_.data(), this->digits_.size(),
+                power.digits_.data(), power.digits_.size()) >= 0) {
+                size++;
+                power.mul_small(10, false);
+            }
+            return size;
+        }
+
+        size_t BigInt::bit_length() const {
+            uint64_t top = this->digits_.back();
+            if (top == 0) {
+                return 0;
+            }
+            return (this->digits_.size() - 1) * 64 + (64 - __builtin_clzll(top));
+        }
+
+        BigInt BigInt::power_of_ten(size_t k) {
+            return pow(BigInt(10), k);
+        }
+
+        BigInt::operator int() const {
+            uint64_t limit = this->isNegative_ ? static_cast<uint64_t>(INT_MAX) + 1 : INT_MAX;
+            if (this->digits_.size() > 1 || this->digits_[0] > limit) {
+                throw BigInt::out_of_bound();
+            }
+            long long int result = this->digits_[0];
+            return this->isNegative_ ? -result : result;
+        }
+
+        BigInt & BigInt::operator=(const BigInt & big_int) {
+            this->isNegative_ = big_int.isNegative_;
+            this->digits_ = big_int.digits_;
+            return *this;
+        }
+
+        BigInt & BigInt::operator=(BigInt && big_int) noexcept {
+            if (this != &big_int) {
+                this->isNegative_ = big_int.isNegative_;
+                this->digits_ = std::move(big_int.digits_);
+                big_int.digits_.assign(1, 0);
+                big_int.isNegative_ = false;
+            }
+            return *this;
+        }
+
+        BigInt BigInt::operator+() const {
+            BigInt tmp(*this);
+            return tmp;
+        }
+
+        BigInt BigInt::operator-() const {
+            BigInt tmp(*this);
+            //zero is never negative
+            tmp.isNegative_ = !tmp.isNegative_ && *this != 0;
+            return tmp;
+        }
+
+        BigInt & BigInt::operator++() {
+            this->add_small(1, false);
+            return *this;
+        }
+
+        const BigInt BigInt::operator++(int) {
+            BigInt tmp = *this;
+            this->add_small(1, false);
+            return tmp;
+        }
+
+        BigInt & BigInt::operator--() {
+            this->add_small(1, true);
+            return *this;
+        }
+
+        const BigInt BigInt::operator--(int) {
+            BigInt tmp = *this;
+            this->add_small(1, true);
+            return tmp;
+        }
+
+        void BigInt::add_signed(const uint64_t * b, size_t nb, bool negative) {
+            if (this->isNegative_ == negative) {
+                //b is shorter or the same limbs, so growing never invalidates it
+                if (this->digits_.size() < nb) {
+                    this->digits_.resize(nb, 0);
+                }
+                uint64_t carry = BigInt::add_limbs(this->digits_.data(), this->digits_.size(), b, nb);
+                if (carry != 0) {
+                    this->digits_.push_back(carry);
+                }
+            }
+            else if (BigInt::compare_limbs(this->digits_.data(), this->digits_.size(), b, nb) >= 0) {
+                BigInt::sub_limbs(this->digits_.data(), this->digits_.size(), b, nb);
+            }
+            else {
+                //|b| > |this|: this = b - this, the result takes the sign of b
+                this->digits_.resize(nb, 0);
+                uint64_t * a = this->digits_.data();
+                uint64_t borrow = 0;
+                for (size_t i = 0; i < nb; i++) {
+                    unsigned __int128 diff = static_cast<unsigned __int128>(b[i]) - a[i] - borrow;
+                    a[i] = static_cast<uint64_t>(diff);
+                    borrow = (diff >> 64) != 0;
+                }
+                this->isNegative_ = negative;
+            }
+            this->remove_leading_zeros();
+        }
+
+        void BigInt::add_small(uint64_t value, bool negative) {
+            this->add_signed(&value, 1, negative);
+        }
+
+        void BigInt::add_product(const BigInt & first, const BigInt & second, bool negative) {
+            if (first == 0 || second == 0) {
+                return;
+            }
+            bool product_negative = (first.isNegative_ != second.isNegative_) != negative;
+            bool first_longer = first.digits_.size() >= second.digits_.size();
+            const BigInt::limb_vector & a = first_longer ? first.digits_ : second.digits_;
+            const BigInt::limb_vector & b = first_longer ? second.digits_ : first.digits_;
+            size_t na = a.size(), nb = b.size();
+            if (nb >= BigInt::karatsuba_threshold_) {
+                BigInt::limb_vector product(na + nb);
+                BigInt::mul_limbs(a.data(), na, b.data(), nb, product.data());
+                size_t size = product[na + nb - 1] == 0 ? na + nb - 1 : na + nb;
+                this->add_signed(product.data(), size, product_negative);
+                return;
+            }
+
+            //accumulate row by row, one spare limb keeps the carry or the sign of a wrap-around
+            size_t n = std::max(this->digits_.size(), na + nb) + 1;
+            this->digits_.resize(n, 0);
+            uint64_t * res = this->digits_.data();
+            if (this->isNegative_ == product_negative) {
+                for (size_t j = 0; j < nb; j++) {
+                    uint64_t carry = BigInt::addmul_1(res + j, a.data(), na, b[j]);
+                    BigInt::add_limbs(res + j + na, n - j - na, &carry, 1);
+                }
+            }
+            else {
+                for (size_t j = 0; j < nb; j++) {
+                    uint64_t borrow = BigInt::submul_1(res + j, a.data(), na, b[j]);
+                    BigInt::sub_limbs(res + j + na, n - j - na, &borrow, 1);
+                }
+                //the product was larger: the limbs hold base^n - |result|
+                if (res[n - 1] != 0) {
+                    for (size_t i = 0; i < n; i++) {
+                        res[i] = ~res[i];
+                    }
+                    uint64_t one = 1;
+                    BigInt::add_limbs(res, n, &one, 1);
+                    this->isNegative_ = product_negative;
+                }
+            }
+            this->remove_leading_zeros();
+        }
+
+        void BigInt::mul_small(uint64_t value, bool negative) {
+            if (value == 0) {
+                this->digits_.assign(1, 0);
+                this->isNegative_ = false;
+                return;
+            }
+            uint64_t carry = 0;
+            for (size_t i = 0; i < this->digits_.size(); i++) {
+                unsigned __int128 cur = static_cast<unsigned __int128>(this->digits_[i]) * value + carry;
+                this->digits_[i] = static_cast<uint64_t>(cur);
+                carry = cur >> 64;
+            }
+            if (carry != 0) {
+                this->digits_.push_back(carry);
+            }
+            this->isNegative_ = this->isNegative_ != negative;
+            this->remove_leading_zeros();
+        }
+
+        uint64_t BigInt::div_small(uint64_t value, bool negative) {
+            if (value == 0) {
+                throw BigInt::divide_by_zero();
+            }
+            uint64_t remainder = BigInt::div_limbs_small(this->digits_.data(), this->digits_.size(), value);
+            this->isNegative_ = this->isNegative_ != negative;
+            this->remove_leading_zeros();
+            return remainder;
+        }
+
+        int BigInt::compare_small(uint64_t value, bool negative) const {
+            if (value == 0) {
+                negative = false;
+            }
+            if (this->isNegative_ != negative) {
+                return this->isNegative_ ? -1 : 1;
+            }
+            int cmp = BigInt::compare_limbs(this->digits_.data(), this->digits_.size(), &value, 1);
+            return this->isNegative_ ? -cmp : cmp;
+        }
+
+        BigInt operator+(const BigInt & first, const BigInt & second) {
+            BigInt result;
+            result.digits_.reserve(std::max(first.digits_.size(), second.digits_.size()) + 1);
+            result = first;
+            result += second;
+            return result;
+        }
+
+        BigInt operator+(BigInt && first, const BigInt & second) {
+            return std::move(first += second);
+        }
+
+        BigInt operator+(const BigInt & first, BigInt && second) {
+            return std::move(second += first);
+        }
+
+        BigInt operator+(BigInt && first, BigInt && second) {
+            return std::move(first += second);
+        }
+
+        BigInt operator-(const BigInt & first, const BigInt & second) {
+            BigInt result;
+            result.digits_.reserve(std::max(first.digits_.size(), second.digits_.size()));
+            result = first;
+            result -= second;
+            return result;
+        }
+
+        BigInt operator-(BigInt && first, const BigInt & second) {
+            return std::move(first -= second);
+        }
+
+        BigInt operator-(const BigInt & first, BigInt && second) {
+            //a - b = -(b - a)
+            second -= first;
+            if (second != 0) {
+                second.isNegative_ = !second.isNegative_;
+            }
+            return std::move(second);
+        }
+
+        BigInt operator-(BigInt && first, BigInt && second) {
+            return std::move(first -= second);
+        }
+
+        int BigInt::compare_limbs(const uint64_t * a, size_t na, const uint64_t * b, size_t nb) {
+            if (na != nb) {
+                return na < nb ? -1 : 1;
+            }
+            for (size_t i = na; i > 0; i--) {
+                if (a[i - 1] != b[i - 1]) {
+                    return a[i - 1] < b[i - 1] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        uint64_t BigInt::div_limbs_small(uint64_t * a, size_t n, uint64_t d) {
+#ifdef BIG_INT_SIMD
+            //rem < d, so the 128 by 64 bit divq cannot overflow
+            uint64_t rem = 0;
+            for (size_t i = n; i > 0; i--) {
+                __asm__("divq %4" : "=a"(a[i - 1]), "=d"(rem) : "a"(a[i - 1]), "d"(rem), "rm"(d) : "cc");
+            }
+            return rem;
+#else
+            unsigned __int128 rem = 0;
+            for (size_t i = n; i > 0; i--) {
+                unsigned __int128 cur = (rem << 64) | a[i - 1];
+                a[i - 1] = static_cast<uint64_t>(cur / d);
+                rem = cur % d;
+            }
+            return static_cast<uint64_t>(rem);
+#endif
+        }
+
+        BigInt BigInt::from_limbs(const uint64_t * p, size_t n) {
+            BigInt result;
+            if (n > 0) {
+                result.digits_.assign(p, p + n);
+                result.remove_leading_zeros();
+            }
+            return result;
+        }
+
+        uint64_t BigInt::add_limbs(uint64_t * a, size_t na, const uint64_t * b, size_t nb) {
+            uint64_t carry = 0;
+            size_t i = 0;
+            for ( ; i < nb; i++) {
+                unsigned __int128 sum = static_cast<unsigned __int128>(a[i]) + b[i] + carry;
+                a[i] = static_cast<uint64_t>(sum);
+                carry = sum >> 64;
+            }
+            for ( ; i < na && carry != 0; i++) {
+                a[i]++;
+                carry = a[i] == 0;
+            }
+            return carry;
+        }
+
+        void BigInt::sub_limbs(uint64_t * a, size_t na, const uint64_t * b, size_t nb) {
+            uint64_t borrow = 0;
+            size_t i = 0;
+            for ( ; i < nb; i++) {
+                unsigned __int128 diff = static_cast<unsigned __int128>(a[i]) - b[i] - borrow;
+                a[i] = static_cast<uint64_t>(diff);
+                borrow = (diff >> 64) != 0;
+            }
+            for ( ; i < na && borrow != 0; i++) {
+                borrow = a[i] == 0;
+                a[i]--;
+            }
+        }
+
+        uint64_t BigInt::addmul_1(uint64_t * res, const uint64_t * a, size_t n, uint64_t b) {
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                unsigned __int128 cur = static_cast<unsigned __int128>(a[i]) * b + res[i] + carry;
+                res[i] = static_cast<uint64_t>(cur);
+                carry = cur >> 64;
+            }
+            return carry;
+        }
+
+        uint64_t BigInt::submul_1(uint64_t * res, const uint64_t * a, size_t n, uint64_t b) {
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < n; i++) {
+                unsigned __int128 prod = static_cast<unsigned __int128>(a[i]) * b + borrow;
+                uint64_t low = static_cast<uint64_t>(prod);
+                borrow = (prod >> 64) + (res[i] < low);
+                res[i] -= low;
+            }
+            return borrow;
+        }
+
+        BigInt::thread_pool::thread_pool() : stop_(false), queued_(0) {}
+
+        BigInt::thread_pool::~thread_pool() {
+            this->stop();
+        }
+
+        BigInt::thread_pool & BigInt::thread_pool::instance() {
+            static BigInt::thread_pool pool;
+            return pool;
+        }
+
+        size_t & BigInt::thread_pool::current() {
+            thread_local size_t index = SIZE_MAX;
+            return index;
+        }
+
+        void BigInt::thread_pool::stop() {
+            {
+                std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+                this->stop_ = true;
+            }
+            this->wake_.notify_all();
+            for (std::thread & worker : this->workers_) {
+                worker.join();
+            }
+            this->workers_.clear();
+            this->queues_.clear();
+            this->stop_ = false;
+        }
+
+        void BigInt::thread_pool::resize(size_t threads) {
+            this->stop();
+            if (threads <= 1) {
+                return;
+            }
+            for (size_t i = 0; i < threads; i++) {
+                this->queues_.push_back(std::make_unique<queue>());
+            }
+            for (size_t i = 0; i + 1 < threads; i++) {
+                this->workers_.emplace_back(&BigInt::thread_pool::work, this, i);
+            }
+        }
+
+        size_t BigInt::thread_pool::size() const {
+            return this->workers_.size() + 1;
+        }
+
+        bool BigInt::thread_pool::run_one(size_t own) {
+            task * t = nullptr;
+            {
+                queue & q = *this->queues_[own];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (q.tasks.empty() == false) {
+                    t = q.tasks.back();
+                    q.tasks.pop_back();
+                }
+            }
+            for (size_t i = 1; t == nullptr && i < this->queues_.size(); i++) {
+                queue & victim = *this->queues_[(own + i) % this->queues_.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.tasks.empty() == false) {
+                    t = victim.tasks.front();
+                    victim.tasks.pop_front();
+                }
+            }
+            if (t == nullptr) {
+                return false;
+            }
+            this->queued_--;
+            try {
+                t->run(t->function);
+            }
+            catch (...) {
+                t->error = std::current_exception();
+            }
+            //the forking thread may destroy the task as soon as it sees done
+            t->done.store(true, std::memory_order_release);
+            //a waiting thread between its check of done and its wait holds the mutex, so the wake-up is not lost
+            {
+                std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+            }
+            this->finished_.notify_all();
+            return true;
+        }
+
+        void BigInt::thread_pool::work(size_t index) {
+            BigInt::thread_pool::current() = index;
+            while (true) {
+                if (this->run_one(index) == true) {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(this->sleep_mutex_);
+                this->wake_.wait(lock, [this] { return this->stop_ || this->queued_ > 0; });
+                if (this->stop_) {
+                    return;
+                }
+            }
+        }
+
+        template <typename F, typename G>
+        void BigInt::thread_pool::fork(F && first, G && second) {
+            if (this->workers_.empty() == true) {
+                first();
+                second();
+                return;
+            }
+            using second_type = typename std::remove_reference<G>::type;
+            task t;
+            t.run = [](void * function) { (*static_cast<second_type *>(function))(); };
+            t.function = &second;
+            t.done = false;
+            size_t own = std::min(BigInt::thread_pool::current(), this->queues_.size() - 1);
+            queue & q = *this->queues_[own];
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.tasks.push_back(&t);
+            }
+            this->queued_++;
+            //a worker between its check of queued_ and its wait holds the mutex, so the wake-up is not lost
+            {
+                std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+            }
+            this->wake_.notify_one();
+
+            std::exception_ptr error;
+            try {
+                first();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            //take second back unless it was stolen, nested forks of first have taken theirs already
+            //it is on top of a worker queue, other outside threads may have pushed above it in the shared one
+            bool taken = false;
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+                auto found = std::find(q.tasks.rbegin(), q.tasks.rend(), &t);
+                if (found != q.tasks.rend()) {
+                    q.tasks.erase(std::next(found).base());
+                    taken = true;
+                }
+            }
+            if (taken == true) {
+                this->queued_--;
+                try {
+                    second();
+                }
+                catch (...) {
+                    t.error = std::current_exception();
+                }
+            }
+            else {
+                while (t.done.load(std::memory_order_acquire) == false) {
+                    if (this->run_one(own) == true) {
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> lock(this->sleep_mutex_);
+                    this->finished_.wait(lock, [this, &t] {
+                        return t.done.load(std::memory_order_acquire) == true || this->queued_ > 0;
+                    });
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            if (t.error) {
+                std::rethrow_exception(t.error);
+            }
+        }
+
+        template <typename F, typename... Rest>
+        void BigInt::thread_pool::invoke(F && first, Rest &&... rest) {
+            if constexpr (sizeof...(Rest) == 0) {
+                first();
+            }
+            else {
+                auto others = [&] { this->invoke(rest...); };
+                this->fork(first, others);
+            }
+        }
+
+        template <typename F>
+        void BigInt::thread_pool::for_range(size_t begin, size_t end, size_t grain, F && body) {
+            if (end - begin <= grain || this->workers_.empty() == true) {
+                body(begin, end);
+                return;
+            }
+            size_t middle = begin + (end - begin) / 2;
+            auto low = [&] { this->for_range(begin, middle, grain, body); };
+            auto high = [&] { this->for_range(middle, end, grain, body); };
+            this->fork(low, high);
+        }
+
+        template <typename... F>
+        void BigInt::parallel(size_t n, F &&... functions) {
+            if (n >= BigInt::parallel_mul_threshold_) {
+                BigInt::thread_pool::instance().invoke(functions...);
+            }
+            else {
+                (functions(), ...);
+            }
+        }
+
+        void BigInt::set_threads(size_t threads) {
+            if (threads == 0) {
+                threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+            }
+            BigInt::thread_pool::instance().resize(threads);
+        }
+
+        size_t BigInt::threads() {
+            return BigInt::thread_pool::instance().size();
+        }
+
+        void BigInt::mul_schoolbook(const uint64_t * a, size_t na, const uint64_t * b, size_t nb, uint64_t * res) {
+            std::fill(res, res + na, 0);
+            for (size_t j = 0; j < nb; j++) {
+                res[j + na] = BigInt::addmul_1(res + j, a, na, b[j]);
+            }
+        }
+
+        void BigInt::mul_karatsuba(const uint64_t * a, size_t na, const uint64_t * b, size_t nb, uint64_t * res) {
+            //a = a1 * base^m + a0, b = b1 * base^m + b0
+            size_t m = na / 2;
+            size_t na1 = na - m, nb1 = nb - m;
+            BigInt::mul_limbs(a, m, b, m, res);
+            BigInt::mul_limbs(a + m, na1, b + m, nb1, res + 2 * m);
+
+            //(a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1 = a0 * b1 + a1 * b0
+            std::vector<uint64_t> sa(a + m, a + na), sb;
+            sa.push_back(BigInt::add_limbs(sa.data(), na1, a, m));
+            if (nb1 >= m) {
+                sb.assign(b + m, b + nb);
+                sb.push_back(BigInt::add_limbs(sb.data(), nb1, b, m));
+            }
+            else {
+                sb.assign(b, b + m);
+                sb.push_back(BigInt::add_limbs(sb.data(), m, b + m, nb1));
+            }
+            std::vector<uint64_t> mid(sa.size() + sb.size());
+            BigInt::mul_limbs(sa.data(), sa.size(), sb.data(), sb.size(), mid.data());
+            BigInt::sub_limbs(mid.data(), mid.size(), res, 2 * m);
+            BigInt::sub_limbs(mid.data(), mid.size(), res + 2 * m, na1 + nb1);
+            size_t mid_size = mid.size();
+            while (mid_size > 0 && mid[mid_size - 1] == 0) {
+                mid_size--;
+            }
+            BigInt::add_limbs(res + m, na + nb - m, mid.data(), mid_size);
+        }
+
+        void BigInt::sqr_schoolbook(const uint64_t * a, size_t n, uint64_t * res) {
+            //cross products a[i] * a[j] with i < j
+            std::fill(res, res + 2 * n, 0);
+            for (size_t i = 0; i + 1 < n; i++) {
+                res[i + n] = BigInt::addmul_1(res + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+            }
+            //double them and add the squares a[i]^2
+            uint64_t shifted = 0, carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                unsigned __int128 sq = static_cast<unsigned __int128>(a[i]) * a[i];
+                uint64_t low = res[2 * i] << 1 | shifted;
+                uint64_t high = res[2 * i + 1] << 1 | res[2 * i] >> 63;
+                shifted = res[2 * i + 1] >> 63;
+                unsigned __int128 sum = static_cast<unsigned __int128>(low) + static_cast<uint64_t>(sq) + carry;
+                res[2 * i] = static_cast<uint64_t>(sum);
+                sum = static_cast<unsigned __int128>(high) + static_cast<uint64_t>(sq >> 64) + (sum >> 64);
+                res[2 * i + 1] = static_cast<uint64_t>(sum);
+                carry = sum >> 64;
+            }
+        }
+
+        void BigInt::sqr_karatsuba(const uint64_t * a, size_t n, uint64_t * res) {
+            //a = a1 * base^m + a0
+            size_t m = n / 2, n1 = n - m;
+            BigInt::sqr_limbs(a, m, res);
+            BigInt::sqr_limbs(a + m, n1, res + 2 * m);
+
+            //|a1 - a0| needs no carry limb, unlike a0 + a1
+            std::vector<uint64_t> d(a + m, a + n), a0(a, a + m);
+            a0.resize(n1);
+            if (std::lexicographical_compare(d.rbegin(), d.rend(), a0.rbegin(), a0.rend())) {
+                d.swap(a0);
+            }
+            BigInt::sub_limbs(d.data(), n1, a0.data(), n1);
+            std::vector<uint64_t> mid(2 * n1 + 1), d2(2 * n1);
+            std::copy(res, res + 2 * m, mid.begin());
+            BigInt::add_limbs(mid.data(), mid.size(), res + 2 * m, 2 * n1);
+            BigInt::sqr_limbs(d.data(), n1, d2.data());
+            BigInt::sub_limbs(mid.data(), mid.size(), d2.data(), d2.size());
+            size_t mid_size = mid.size();
+            while (mid_size > 0 && mid[mid_size - 1] == 0) {
+                mid_size--;
+            }
+            BigInt::add_limbs(res + m, 2 * n - m, mid.data(), mid_size);
+        }
+
+        void BigInt::mul_toom3(const uint64_t * a, size_t na, const uint64_t * b, size_t nb, uint64_t * res) {
+            //a = a2 * x^2 + a1 * x + a0 with x = base^k, the same for b
+            //b2 may be shorter than k or even empty
+            size_t k = (na + 2) / 3;
+            BigInt a0 = BigInt::from_limbs(a, k);
+            BigInt a1 = BigInt::from_limbs(a + k, k);
+            BigInt a2 = BigInt::from_limbs(a + 2 * k, na - 2 * k);
+            BigInt b0 = BigInt::from_limbs(b, k);
+            BigInt b1 = BigInt::from_limbs(b + k, std::min(k, nb - k));
+            BigInt b2 = nb > 2 * k ? BigInt::from_limbs(b + 2 * k, nb - 2 * k) : BigInt();
+
+            //evaluate at 0, 1, -1, -2 and infinity
+            BigInt t = a0 + a2;
+            BigInt p1 = t + a1, pm1 = t - a1;
+            BigInt pm2 = (pm1 + a2) + (pm1 + a2) - a0;
+            t = b0 + b2;
+            BigInt q1 = t + b1, qm1 = t - b1;
+            BigInt qm2 = (qm1 + b2) + (qm1 + b2) - b0;
+
+            //the five products are independent
+            BigInt r0, r1, rm1, rm2, rinf;
+            BigInt::parallel(na,
+                [&] { r0 = a0 * b0; },
+                [&] { r1 = p1 * q1; },
+                [&] { rm1 = pm1 * qm1; },
+                [&] { rm2 = pm2 * qm2; },
+                [&] { rinf = a2 * b2; });
+            BigInt::toom3_interpolate(r0, r1, rm1, rm2, rinf, k, res, na + nb);
+        }
+
+        void BigInt::sqr_toom3(const uint64_t * a, size_t n, uint64_t * res) {
+            size_t k = (n + 2) / 3;
+            BigInt a0 = BigInt::from_limbs(a, k);
+            BigInt a1 = BigInt::from_limbs(a + k, k);
+            BigInt a2 = BigInt::from_limbs(a + 2 * k, n - 2 * k);
+
+            BigInt t = a0 + a2;
+            BigInt p1 = t + a1, pm1 = t - a1;
+            BigInt pm2 = (pm1 + a2) + (pm1 + a2) - a0;
+
+            BigInt r0, r1, rm1, rm2, rinf;
+            BigInt::parallel(n,
+                [&] { r0 = square(a0); },
+                [&] { r1 = square(p1); },
+                [&] { rm1 = square(pm1); },
+                [&] { rm2 = square(pm2); },
+                [&] { rinf = square(a2); });
+            BigInt::toom3_interpolate(r0, r1, rm1, rm2, rinf, k, res, 2 * n);
+        }
+
+        void BigInt::toom3_interpolate(BigInt & r0, BigInt & r1, BigInt & rm1, BigInt & rm2, BigInt & rinf,
+            size_t k, uint64_t * res, size_t n) {
+            //Bodrato's sequence, all divisions are exact
+            BigInt r3 = rm2 - r1;
+            BigInt::div_limbs_small(r3.digits_.data(), r3.digits_.size(), 3);
+            r3.remove_leading_zeros();
+            r1 = r1 - rm1;
+            BigInt::div_limbs_small(r1.digits_.data(), r1.digits_.size(), 2);
+            r1.remove_leading_zeros();
+            BigInt r2 = rm1 - r0;
+            r3 = r2 - r3;
+            BigInt::div_limbs_small(r3.digits_.data(), r3.digits_.size(), 2);
+            r3.remove_leading_zeros();
+            r3 = r3 + rinf + rinf;
+            r2 = r2 + r1 - rinf;
+            r1 = r1 - r3;
+
+            std::fill(res, res + n, 0);
+            const BigInt * coeffs[] = {&r0, &r1, &r2, &r3, &rinf};
+            for (size_t i = 0; i < 5; i++) {
+                const BigInt::limb_vector & c = coeffs[i]->digits_;
+                size_t c_size = c.size();
+                while (c_size > 0 && c[c_size - 1] == 0) {
+                    c_size--;
+                }
+                if (c_size > 0) {
+                    BigInt::add_limbs(res + i * k, n - i * k, c.data(), c_size);
+                }
+            }
+        }
+
+        unsigned int BigInt::pow_mod(unsigned int base, unsigned long long int exp, unsigned int mod) {
+            unsigned long long int result = 1, cur = base % mod;
+            while (exp != 0) {
+                if (exp & 1) {
+                    result = result * cur % mod;
+                }
+                cur = cur * cur % mod;
+                exp >>= 1;
+            }
+            return result;
+        }
+
+        void BigInt::ntt(std::vector<unsigned int> & a, bool invert, unsigned int mod) {
+            size_t n = a.size();
+            for (size_t i = 1, j = 0; i < n; i++) {
+                size_t bit = n >> 1;
+                for ( ; j & bit; bit >>= 1) {
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j) {
+                    std::swap(a[i], a[j]);
+                }
+            }
+            //long transforms split every stage across the thread pool, the stages run one after another
+            BigInt::thread_pool & pool = BigInt::thread_pool::instance();
+            size_t grain = n < BigInt::parallel_ntt_threshold_ ? n : std::max<size_t>(n / (8 * pool.size()), 4096);
+            std::vector<unsigned int> roots(n / 2);
+            unsigned int * data = a.data(), * w = roots.data();
+            for (size_t len = 2; len <= n; len <<= 1) {
+                unsigned long long int wlen = BigInt::pow_mod(3, (mod - 1) / len, mod);
+                if (invert) {
+                    wlen = BigInt::pow_mod(wlen, mod - 2, mod);
+                }
+                size_t half = len / 2;
+                pool.for_range(0, half, grain, [=](size_t lo, size_t hi) {
+                    BigInt::ntt_powers(w, lo, hi, wlen, mod);
+                });
+                pool.for_range(0, n / 2, grain, [=](size_t lo, size_t hi) {
+                    BigInt::ntt_butterflies(data, w, lo, hi, half, mod);
+                });
+            }
+            if (invert) {
+                unsigned long long int n_inv = BigInt::pow_mod(n % mod, mod - 2, mod);
+                pool.for_range(0, n, grain, [=](size_t lo, size_t hi) {
+                    BigInt::ntt_scale(data, lo, hi, n_inv, mod);
+                });
+            }
+        }
+
+        void BigInt::ntt_powers(unsigned int * w, size_t lo, size_t hi, unsigned long long int wlen, unsigned int mod) {
+            //every piece starts from its own power
+            unsigned long long int power = BigInt::pow_mod(wlen, lo, mod);
+            for (size_t k = lo; k < hi; k++) {
+                w[k] = power;
+                power = power * wlen % mod;
+            }
+        }
+
+        void BigInt::ntt_butterflies(unsigned int * a, const unsigned int * w, size_t lo, size_t hi, size_t half, unsigned int mod) {
+            for (size_t j = lo; j < hi; ) {
+                //half is a power of two
+                unsigned int * x = a + (j & ~(half - 1)) * 2;
+                size_t first = j & (half - 1), last = std::min(half, first + (hi - j));
+                for (size_t k = first; k < last; k++) {
+                    unsigned int u = x[k];
+                    unsigned int v = static_cast<unsigned long long int>(x[k + half]) * w[k] % mod;
+                    x[k] = u + v < mod ? u + v : u + v - mod;
+                    x[k + half] = u >= v ? u - v : u + mod - v;
+                }
+                j += last - first;
+            }
+        }
+
+        void BigInt::ntt_scale(unsigned int * a, size_t lo, size_t hi, unsigned long long int factor, unsigned int mod) {
+            for (size_t i = lo; i < hi; i++) {
+                a[i] = a[i] * factor % mod;
+            }
+        }
+
+        void BigInt::mul_ntt(const uint64_t * a, size_t na, const uint64_t * b, size_t nb, uint64_t * res) {
+            //every coefficient is below min(2 * na, 2 * nb) * 2^64 < m1 * m2 * m3
+            static const unsigned int primes[3] = {998'244'353, 167'772'161, 469'762'049};
+            size_t pieces = 2 * (na + nb);
+            size_t n = 1;
+            while (n < pieces) {
+                n <<= 1;
+            }
+            //a square transforms its operand once
+            bool square = a == b && na == nb;
+            std::vector<unsigned int> residues[3];
+            auto convolve = [&](int p) {
+                unsigned int mod = primes[p];
+                std::vector<unsigned int> fa(n), fb(square ? 0 : n);
+                for (size_t i = 0; i < na; i++) {
+                    fa[2 * i] = static_cast<uint32_t>(a[i]) % mod;
+                    fa[2 * i + 1] = (a[i] >> 32) % mod;
+                }
+                BigInt::ntt(fa, false, mod);
+                if (square == false) {
+                    for (size_t i = 0; i < nb; i++) {
+                        fb[2 * i] = static_cast<uint32_t>(b[i]) % mod;
+                        fb[2 * i + 1] = (b[i] >> 32) % mod;
+                    }
+                    BigInt::ntt(fb, false, mod);
+                }
+                const std::vector<unsigned int> & other = square ? fa : fb;
+                for (size_t i = 0; i < n; i++) {
+                    fa[i] = static_cast<unsigned long long int>(fa[i]) * other[i] % mod;
+                }
+                BigInt::ntt(fa, true, mod);
+                residues[p] = std::move(fa);
+            };
+            //the three primes are independent
+            BigInt::parallel(na + nb, [&] { convolve(0); }, [&] { convolve(1); }, [&] { convolve(2); });
+
+            const unsigned long long int m1 = primes[0], m2 = primes[1], m3 = primes[2];
+            const unsigned long long int m12 = m1 * m2;
+            const unsigned long long int m1_inv = BigInt::pow_mod(m1 % m2, m2 - 2, m2);
+            const unsigned long long int m12_inv = BigInt::pow_mod(m12 % m3, m3 - 2, m3);
+            unsigned __int128 carry = 0;
+            for (size_t i = 0; i < pieces; i++) {
+                unsigned long long int r1 = residues[0][i], r2 = residues[1][i], r3 = residues[2][i];
+                unsigned long long int x12 = r1 + m1 * ((r2 + m2 - r1 % m2) % m2 * m1_inv % m2);
+                unsigned long long int t = (r3 + m3 - x12 % m3) % m3 * m12_inv % m3;
+                carry += x12 + static_cast<unsigned __int128>(m12) * t;
+                uint64_t piece = static_cast<uint32_t>(carry);
+                carry >>= 32;
+                if (i % 2 == 0) {
+                    res[i / 2] = piece;
+                }
+                else {
+                    res[i / 2] |= piece << 32;
+                }
+            }
+        }
+
+        void BigInt::sqr_limbs(const uint64_t * a, size_t n, uint64_t * res) {
+            if (n < BigInt::sqr_karatsuba_threshold_) {
+                BigInt::sqr_schoolbook(a, n, res);
+            }
+            else if (n >= BigInt::ntt_threshold_ && 2 * n <= BigInt::ntt_max_size_) {
+                BigInt::mul_ntt(a, n, a, n, res);
+            }
+            else if (n < BigInt::toom3_threshold_) {
+                BigInt::sqr_karatsuba(a, n, res);
+            }
+            else {
+                BigInt::sqr_toom3(a, n, res);
+            }
+        }
+
+        void BigInt::mul_limbs(const uint64_t * a, size_t na, const uint64_t * b, size_t nb, uint64_t * res) {
+            if (a == b && na == nb) {
+                BigInt::sqr_limbs(a, na, res);
+                return;
+            }
+            if (na < nb) {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+            if (nb < BigInt::karatsuba_threshold_) {
+                BigInt::mul_schoolbook(a, na, b, nb, res);
+                return;
+            }
+            if (nb >= BigInt::ntt_threshold_ && na + nb <= BigInt::ntt_max_size_) {
+                BigInt::mul_ntt(a, na, b, nb, res);
+                return;
+            }
+            //unbalanced operands: multiply b by nb-sized slices of a
+            if (2 * nb <= na) {
+                std::fill(res, res + na + nb, 0);
+                std::vector<uint64_t> part(2 * nb);
+                for (size_t i = 0; i < na; i += nb) {
+                    size_t len = std::min(nb, na - i);
+                    BigInt::mul_limbs(a + i, len, b, nb, part.data());
+                    BigInt::add_limbs(res + i, na + nb - i, part.data(), len + nb);
+                }
+                return;
+            }
+            if (nb < BigInt::toom3_threshold_) {
+                BigInt::mul_karatsuba(a, na, b, nb, res);
+            }
+            else {
+                BigInt::mul_toom3(a, na, b, nb, res);
+            }
+        }
+
+        BigInt::limb_vector BigInt::multiply(const BigInt::limb_vector & a, const BigInt::limb_vector & b) {
+            BigInt::limb_vector result(a.size() + b.size());
+            BigInt::mul_limbs(a.data(), a.size(), b.data(), b.size(), result.data());
+            return result;
+        }
+
+        BigInt square(const BigInt & big_int) {
+            BigInt result;
+            size_t n = big_int.digits_.size();
+            result.digits_.resize(2 * n);
+            BigInt::sqr_limbs(big_int.digits_.data(), n, result.digits_.data());
+            result.remove_leading_zeros();
+            return result;
+        }
+
+        BigInt pow(const BigInt & base, uint64_t exp) {
+            if (exp == 0) {
+                return BigInt(1);
+            }
+            if (base == 0 || exp == 1) {
+                return base;
+            }
+            //base = odd * 2^shift, the power of two is a shift at the end
+            size_t zero_limbs = 0;
+            while (base.digits_[zero_limbs] == 0) {
+                zero_limbs++;
+            }
+            size_t shift = zero_limbs * 64 + __builtin_ctzll(base.digits_[zero_limbs]);
+            BigInt odd = base >> shift;
+            odd.isNegative_ = false;
+            size_t bits = odd.bit_length();
+            if (bits > SIZE_MAX / 2 / exp || shift > SIZE_MAX / 2 / exp) {
+                throw BigInt::out_of_bound();
+            }
+
+            BigInt result;
+            if (bits == 1) {
+                result = BigInt(1);
+            }
+            else {
+                //odd powers base^1, base^3, ..., base^(2^window - 1)
+                int exp_bits = 64 - __builtin_clzll(exp);
+                int window = exp_bits <= 6 ? 1 : exp_bits <= 24 ? 3 : exp_bits <= 80 ? 4 : 5;
+                std::vector<BigInt> powers(static_cast<size_t>(1) << (window - 1));
+                powers[0] = odd;
+                if (powers.size() > 1) {
+                    BigInt odd2 = square(odd);
+                    for (size_t i = 1; i < powers.size(); i++) {
+                        powers[i] = powers[i - 1] * odd2;
+                    }
+                }
+
+                //every intermediate value is at most the result, one spare limb for unnormalized products
+                size_t capacity = (bits * exp + 63) / 64 + 1;
+                BigInt::limb_vector cur, tmp;
+                cur.reserve(capacity);
+                tmp.reserve(capacity);
+                size_t cur_size = 0;
+                auto square_cur = [&]() {
+                    tmp.resize(2 * cur_size);
+                    BigInt::sqr_limbs(cur.data(), cur_size, tmp.data());
+                    cur.swap(tmp);
+                    cur_size = 2 * cur_size;
+                    while (cur[cur_size - 1] == 0) {
+                        cur_size--;
+                    }
+                };
+                int i = exp_bits - 1;
+                while (i >= 0) {
+                    if ((exp >> i & 1) == 0) {
+                        square_cur();
+                        i--;
+                        continue;
+                    }
+                    //the longest window exp[low, i] of at most window bits ending in a one
+                    int low = std::max(i - window + 1, 0);
+                    while ((exp >> low & 1) == 0) {
+                        low++;
+                    }
+                    const BigInt::limb_vector & factor = powers[(exp >> low & ((2ULL << (i - low)) - 1)) >> 1].digits_;
+                    if (cur_size == 0) {
+                        cur.assign(factor.begin(), factor.end());
+                        cur_size = factor.size();
+                    }
+                    else {
+                        for (int j = i; j >= low; j--) {
+                            square_cur();
+                        }
+                        tmp.resize(cur_size + factor.size());
+                        BigInt::mul_limbs(cur.data(), cur_size, factor.data(), factor.size(), tmp.data());
+                        cur.swap(tmp);
+                        cur_size += factor.size();
+                        while (cur[cur_size - 1] == 0) {
+                            cur_size--;
+                        }
+                    }
+                    i = low - 1;
+                }
+                cur.resize(cur_size);
+                result.digits_.swap(cur);
+            }
+            if (shift != 0) {
+                result <<= shift * exp;
+            }
+            result.isNegative_ = base.isNegative_ && (exp & 1) == 1;
+            return result;
+        }
+
+        BigInt operator*(const BigInt & first, const BigInt & second) {
+            if (&first == &second) {
+                return square(first);
+            }
+            BigInt result;
+            if (first == result || second == result) {
+                return result;
+            }
+            result.digits_ = BigInt::multiply(first.digits_, second.digits_);
+            if (first.isNegative_ == second.isNegative_) {
+                result.isNegative_ = false;
+            }
+            else if (first.isNegative_ != second.isNegative_) {
+                result.isNegative_ = true;
+            }
+            result.remove_leading_zeros();
+            return result;
+        }
+
+        void BigInt::div_limbs(const BigInt::limb_vector & a, const BigInt::limb_vector & b,
+            BigInt::limb_vector & q, BigInt::limb_vector & r) {
+            size_t na = a.size(), nb = b.size();
+            if (BigInt::compare_limbs(a.data(), na, b.data(), nb) < 0) {
+                q.assign(1, 0);
+                r = a;
+                return;
+            }
+            if (nb == 1) {
+                q = a;
+                r.assign(1, BigInt::div_limbs_small(q.data(), na, b[0]));
+                return;
+            }
+
+            //shift both operands so that the top bit of the divisor is set
+            int shift = __builtin_clzll(b[nb - 1]);
+            std::vector<uint64_t> u(na + 1), v(nb);
+            for (size_t i = nb; i > 0; i--) {
+                v[i - 1] = b[i - 1] << shift;
+                if (shift != 0 && i > 1) {
+                    v[i - 1] |= b[i - 2] >> (64 - shift);
+                }
+            }
+            u[na] = shift != 0 ? a[na - 1] >> (64 - shift) : 0;
+            for (size_t i = na; i > 0; i--) {
+                u[i - 1] = a[i - 1] << shift;
+                if (shift != 0 && i > 1) {
+                    u[i - 1] |= a[i - 2] >> (64 - shift);
+                }
+            }
+
+            q.assign(na - nb + 1, 0);
+            uint64_t v_top = v[nb - 1], v_next = v[nb - 2];
+            for (size_t j = na - nb + 1; j > 0; j--) {
+                size_t pos = j - 1;
+                //estimate the quotient limb from the top two limbs of the remainder
+                unsigned __int128 num = (static_cast<unsigned __int128>(u[pos + nb]) << 64) | u[pos + nb - 1];
+                unsigned __int128 qhat = num / v_top, rhat = num % v_top;
+                while ((qhat >> 64) != 0 || qhat * v_next > ((rhat << 64) | u[pos + nb - 2])) {
+                    qhat--;
+                    rhat += v_top;
+                    if ((rhat >> 64) != 0) {
+                        break;
+                    }
+                }
+
+                //u[pos, pos + nb] -= qhat * v
+                uint64_t top = BigInt::submul_1(u.data() + pos, v.data(), nb, static_cast<uint64_t>(qhat));
+                bool borrow = u[pos + nb] < top;
+                u[pos + nb] -= top;
+
+                //the estimate was one too large: add the divisor back
+                if (borrow == true) {
+                    qhat--;
+                    BigInt::add_limbs(u.data() + pos, nb + 1, v.data(), nb);
+                }
+                q[pos] = static_cast<uint64_t>(qhat);
+            }
+
+            //the remainder is the low part of u shifted back
+            r.assign(nb, 0);
+            for (size_t i = 0; i < nb; i++) {
+                r[i] = u[i] >> shift;
+                if (shift != 0) {
+                    r[i] |= u[i + 1] << (64 - shift);
+                }
+            }
+        }
+
+        BigInt BigInt::shift_limbs(long long int k) const {
+            BigInt result(*this);
+            if (k > 0 && result.digits_.back() != 0) {
+                result.digits_.insert(result.digits_.begin(), k, 0);
+            }
+            else if (k < 0) {
+                if (static_cast<size_t>(-k) >= result.digits_.size()) {
+                    return BigInt();
+                }
+                result.digits_.erase(result.digits_.begin(), result.digits_.begin() - k);
+            }
+            return result;
+        }
+
+        BigInt::reciprocal::reciprocal(const BigInt & divisor) {
+            if (divisor == BigInt()) {
+                throw BigInt::divide_by_zero();
+            }
+            this->divisor_ = divisor;
+            this->divisor_.isNegative_ = false;
+            this->isNegative_ = divisor.isNegative_;
+            this->inverse_ = BigInt::reciprocal::inverse(this->divisor_);
+        }
+
+        BigInt BigInt::reciprocal::inverse(const BigInt & b) {
+            size_t n = b.digits_.size();
+            BigInt one;
+            one.digits_.assign(2 * n + 1, 0);
+            one.digits_.back() = 1;
+            if (n < BigInt::newton_threshold_ / 4) {
+                BigInt result, remainder;
+                BigInt::div_limbs(one.digits_, b.digits_, result.digits_, remainder.digits_);
+                result.remove_leading_zeros();
                 return result;
             }
+
+            //start from the reciprocal of the top k limbs, two guard limbs
+            //make the error after one newton step less than one unit
+            size_t k = (n + 1) / 2 + 2;
+            BigInt x = BigInt::reciprocal::inverse(b.shift_limbs(-static_cast<long long int>(n - k)));
+            x = x.shift_limbs(n - k);
+
+            //x += x * (base^(2n) - b * x) / base^(2n)
+            BigInt error = one - b * x;
+            x += (x * error).shift_limbs(-2 * static_cast<long long int>(n));
+
+            //fix the last units lost by truncation
+            BigInt remainder = one - b * x;
+            while (remainder.isNegative_ == true) {
+                x -= 1;
+                remainder += b;
+            }
+            while (remainder >= b) {
+                x += 1;
+                remainder -= b;
+            }
+            return x;
+        }
+
+        void BigInt::reciprocal::divide_magnitude(const BigInt & a, BigInt & q, BigInt & r) const {
+            size_t n = this->divisor_.digits_.size();
+            size_t na = a.digits_.size();
+            q.digits_.assign(na, 0);
+            q.isNegative_ = false;
+            r = BigInt();
+            //blocks of n limbs from the top, every partial dividend is below divisor * base^n
+            size_t top = na % n == 0 ? n : na % n;
+            for (size_t hi = na, lo = na - top; hi > 0; hi = lo, lo = hi >= n ? hi - n : 0) {
+                BigInt chunk = r.shift_limbs(hi - lo) + BigInt::from_limbs(a.digits_.data() + lo, hi - lo);
+                BigInt chunk_q = (chunk * this->inverse_).shift_limbs(-2 * static_cast<long long int>(n));
+                r = chunk - chunk_q * this->divisor_;
+                while (r >= this->divisor_) {
+                    chunk_q += 1;
+                    r -= this->divisor_;
+                }
+                std::copy(chunk_q.digits_.begin(), chunk_q.digits_.end(), q.digits_.begin() + lo);
+            }
+            q.remove_leading_zeros();
+        }
+
+        const BigInt & BigInt::reciprocal::divisor() const {
+            return this->divisor_;
+        }
+
+        std::pair<BigInt, BigInt> BigInt::reciprocal::divmod(const BigInt & dividend) const {
+            BigInt q, r, a = dividend;
+            a.isNegative_ = false;
+            this->divide_magnitude(a, q, r);
+            q.isNegative_ = dividend.isNegative_ != this->isNegative_;
+            q.remove_leading_zeros();
+            if (dividend.isNegative_ == true && r != BigInt()) {
+                r = this->divisor_ - r;
+            }
+            return std::make_pair(q, r);
+        }
+
+        BigInt BigInt::reciprocal::quotient(const BigInt & dividend) const {
+            return this->divmod(dividend).first;
+        }
+
+        BigInt BigInt::reciprocal::remainder(const BigInt & dividend) const {
+            return this->divmod(dividend).second;
+        }
+
+        BigInt::montgomery::montgomery(const BigInt & modulus) {
+            if (modulus <= 0 || (modulus.digits_[0] & 1) == 0) {
+                throw BigInt::invalid_argument();
+            }
+            this->modulus_ = modulus;
+            //newton's iteration doubles the correct low bits, m * m = 1 mod 8 gives the first three
+            uint64_t m = modulus.digits_[0], inverse = m;
+            for (int i = 0; i < 5; i++) {
+                inverse *= 2 - m * inverse;
+            }
+            this->inverse_ = 0 - inverse;
+            size_t n = this->size();
+            this->one_ = ((BigInt(1) << 64 * n) % modulus).digits_;
+            this->one_.resize(n);
+            this->r2_ = ((BigInt(1) << 128 * n) % modulus).digits_;
+            this->r2_.resize(n);
+        }
+
+        const BigInt & BigInt::montgomery::modulus() const {
+            return this->modulus_;
+        }
+
+        size_t BigInt::montgomery::size() const {
+            return this->modulus_.digits_.size();
+        }
+
+        void BigInt::montgomery::reduce(uint64_t * t, uint64_t * res) const {
+            size_t n = this->size();
+            const uint64_t * m = this->modulus_.digits_.data();
+            //clear one limb per step by adding a multiple of the modulus
+            t[2 * n] = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t carry = BigInt::addmul_1(t + i, m, n, t[i] * this->inverse_);
+                BigInt::add_limbs(t + i + n, n + 1 - i, &carry, 1);
+            }
+            //t / base^n < 2 * modulus
+            uint64_t * high = t + n;
+            if (high[n] != 0 || BigInt::compare_limbs(high, n, m, n) >= 0) {
+                BigInt::sub_limbs(high, n + 1, m, n);
+            }
+            std::copy(high, high + n, res);
+        }
+
+        void BigInt::montgomery::multiply(const uint64_t * a, const uint64_t * b, uint64_t * res) const {
+            size_t n = this->size();
+            thread_local std::vector<uint64_t> scratch;
+            if (scratch.size() < 2 * n + 1) {
+                scratch.resize(2 * n + 1);
+            }
+            if (n >= BigInt::montgomery_threshold_) {
+                BigInt::mul_limbs(a, n, b, n, scratch.data());
+            }
+            else if (a == b) {
+                BigInt::sqr_schoolbook(a, n, scratch.data());
+            }
+            else {
+                BigInt::mul_schoolbook(a, n, b, n, scratch.data());
+            }
+            this->reduce(scratch.data(), res);
+        }
+
+        void BigInt::montgomery::add(const uint64_t * a, const uint64_t * b, uint64_t * res) const {
+            size_t n = this->size();
+            const uint64_t * m = this->modulus_.digits_.data();
+            //addition commutes, so a result in place of b is one in place of a
+            if (res == b) {
+                std::swap(a, b);
+            }
+            if (res != a) {
+                std::copy(a, a + n, res);
+            }
+            uint64_t carry = BigInt::add_limbs(res, n, b, n);
+            if (carry != 0 || BigInt::compare_limbs(res, n, m, n) >= 0) {
+                //the borrow cancels the carry
+                BigInt::sub_limbs(res, n, m, n);
+            }
+        }
+
+        void BigInt::montgomery::subtract(const uint64_t * a, const uint64_t * b, uint64_t * res) const {
+            size_t n = this->size();
+            //one pass reads a[i] and b[i] before res[i] is written, so res may be either of them
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < n; i++) {
+                unsigned __int128 diff = static_cast<unsigned __int128>(a[i]) - b[i] - borrow;
+                res[i] = static_cast<uint64_t>(diff);
+                borrow = (diff >> 64) != 0;
+            }
+            //a - b + modulus wraps around base^n when a < b
+            if (borrow != 0) {
+                BigInt::add_limbs(res, n, this->modulus_.digits_.data(), n);
+            }
+        }
+
+        void BigInt::montgomery::negate(const uint64_t * a, uint64_t * res) const {
+            size_t n = this->size();
+            bool zero = std::all_of(a, a + n, [](uint64_t limb) { return limb == 0; });
+            if (zero == true) {
+                std::fill(res, res + n, 0);
+                return;
+            }
+            //modulus - a, a is already reduced
+            const uint64_t * m = this->modulus_.digits_.data();
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < n; i++) {
+                unsigned __int128 diff = static_cast<unsigned __int128>(m[i]) - a[i] - borrow;
+                res[i] = static_cast<uint64_t>(diff);
+                borrow = (diff >> 64) != 0;
+            }
+        }
+
+        void BigInt::montgomery::to_montgomery(const BigInt & x, uint64_t * res) const {
+            size_t n = this->size();
+            BigInt::limb_vector value = (x % this->modulus_).digits_;
+            value.resize(n);
+            this->multiply(value.data(), this->r2_.data(), res);
+        }
+
+        BigInt BigInt::montgomery::from_montgomery(const uint64_t * a) const {
+            size_t n = this->size();
+            std::vector<uint64_t> t(2 * n + 1);
+            std::copy(a, a + n, t.begin());
+            this->reduce(t.data(), t.data());
+            return BigInt::from_limbs(t.data(), n);
+        }
+
+        const uint64_t * BigInt::montgomery::one() const {
+            return this->one_.data();
+        }
+
+        void BigInt::montgomery::pow(const uint64_t * a, const BigInt & exp, uint64_t * res) const {
+            size_t n = this->size();
+            size_t bits = exp.bit_length();
+            if (bits == 0) {
+                std::copy(this->one_.begin(), this->one_.end(), res);
+                return;
+            }
+            //table[i] = a^i
+            size_t window = bits <= 24 ? 1 : bits <= 128 ? 3 : bits <= 512 ? 4 : bits <= 2048 ? 5 : 6;
+            std::vector<uint64_t> table(n << window);
+            std::copy(this->one_.begin(), this->one_.end(), table.begin());
+            std::copy(a, a + n, table.begin() + n);
+            for (size_t i = 2; i < static_cast<size_t>(1) << window; i++) {
+                this->multiply(&table[(i - 1) * n], &table[n], &table[i * n]);
+            }
+
+            //windows of the exponent from the highest, the top one may be shorter
+            auto chunk = [&exp](size_t low, size_t width) {
+                size_t value = 0;
+                for (size_t i = low + width; i > low; i--) {
+                    value = value << 1 | (exp.digits_[(i - 1) / 64] >> (i - 1) % 64 & 1);
+                }
+                return value;
+            };
+            size_t low = (bits - 1) / window * window;
+            const uint64_t * top = &table[chunk(low, bits - low) * n];
+            std::copy(top, top + n, res);
+            while (low > 0) {
+                low -= window;
+                for (size_t i = 0; i < window; i++) {
+                    this->multiply(res, res, res);
+                }
+                size_t value = chunk(low, window);
+                if (value != 0) {
+                    this->multiply(res, &table[value * n], res);
+                }
+            }
+        }
+
+        unsigned __int128 BigInt::top_bits(size_t shift) const {
+            size_t i = shift / 64, r = shift % 64, n = this->digits_.size();
+            uint64_t limbs[3];
+            for (size_t j = 0; j < 3; j++) {
+                limbs[j] = i + j < n ? this->digits_[i + j] : 0;
+            }
+            uint64_t low = limbs[0], high = limbs[1];
+            if (r != 0) {
+                low = limbs[0] >> r | limbs[1] << (64 - r);
+                high = limbs[1] >> r | limbs[2] << (64 - r);
+            }
+            unsigned __int128 result = static_cast<unsigned __int128>(high) << 64 | low;
+            return result & ((static_cast<unsigned __int128>(1) << 124) - 1);
+        }
+
+        void BigInt::lehmer_matrix(const BigInt & a, const BigInt & b, size_t stop, int64_t (&t)[4]) {
+            //knuth's algorithm l, the quotient is certain if both ends of the leading parts agree on it
+            const __int128 limit = static_cast<__int128>(1) << 62;
+            size_t na = a.bit_length();
+            size_t shift = na > 124 ? na - 124 : 0;
+            __int128 x = a.top_bits(shift), y = b.top_bits(shift);
+            __int128 A = 1, B = 0, C = 0, D = 1;
+            //most quotients are small, a few subtractions are cheaper than a 128-bit division
+            auto quotient = [](__int128 n, __int128 d) {
+                if (n >= 8 * d) {
+                    return n / d;
+                }
+                __int128 q = 0;
+                for ( ; n >= d; n -= d) {
+                    q++;
+                }
+                return q;
+            };
+            while (true) {
+                __int128 q;
+                if (shift == 0) {
+                    //exact values
+                    if (y == 0) {
+                        break;
+                    }
+                    q = quotient(x, y);
+                }
+                else {
+                    if (y + C <= 0 || y + D <= 0 || x + A < 0 || x + B < 0) {
+                        break;
+                    }
+                    q = quotient(x + A, y + C);
+                    if (q != quotient(x + B, y + D)) {
+                        break;
+                    }
+                }
+                if (q >= limit) {
+                    break;
+                }
+                __int128 next_c = A - q * C, next_d = B - q * D;
+                if (next_c >= limit || next_c <= -limit || next_d >= limit || next_d <= -limit) {
+                    break;
+                }
+                A = C;
+                C = next_c;
+                B = D;
+                D = next_d;
+                __int128 next_y = x - q * y;
+                x = y;
+                y = next_y;
+                uint64_t y_high = static_cast<uint64_t>(y >> 64), y_low = static_cast<uint64_t>(y);
+                size_t y_bits = y_high != 0 ? 128 - __builtin_clzll(y_high) : y_low != 0 ? 64 - __builtin_clzll(y_low) : 0;
+                if (shift + y_bits <= stop) {
+                    break;
+                }
+            }
+            t[0] = static_cast<int64_t>(A);
+            t[1] = static_cast<int64_t>(B);
+            t[2] = static_cast<int64_t>(C);
+            t[3] = static_cast<int64_t>(D);
+        }
+
+        bool BigInt::combine_limbs(const uint64_t * a, size_t na, const uint64_t * b, size_t nb,
+            int64_t s, int64_t t, uint64_t * out) {
+            std::fill(out, out + na, 0);
+            out[na] = BigInt::addmul_1(out, a, na, BigInt::magnitude(s));
+            bool negative = s < 0;
+            if (s == 0 || (s < 0) == (t < 0)) {
+                uint64_t carry = BigInt::addmul_1(out, b, nb, BigInt::magnitude(t));
+                BigInt::add_limbs(out + nb, na + 1 - nb, &carry, 1);
+                return s == 0 ? t < 0 : negative;
+            }
+            uint64_t borrow = BigInt::submul_1(out, b, nb, BigInt::magnitude(t));
+            bool wrapped = false;
+            for (size_t i = nb; i <= na && borrow != 0; i++) {
+                uint64_t before = out[i];
+                out[i] -= borrow;
+                borrow = before < borrow;
+                wrapped = i == na && borrow != 0;
+            }
+            if (wrapped == true) {
+                //two's complement over na + 1 limbs
+                uint64_t carry = 1;
+                for (size_t i = 0; i <= na; i++) {
+                    out[i] = ~out[i] + carry;
+                    carry = carry == 1 && out[i] == 0;
+                }
+                negative = !negative;
+            }
+            return negative;
+        }
+
+        void BigInt::transform(BigInt::euclid_state & st, const int64_t (&t)[4]) {
+            size_t na = st.a.digits_.size(), nb = st.b.digits_.size();
+            BigInt rows[2];
+            for (int r = 0; r < 2; r++) {
+                rows[r].digits_.resize(na + 1);
+                rows[r].isNegative_ = BigInt::combine_limbs(st.a.digits_.data(), na, st.b.digits_.data(), nb,
+                    t[2 * r], t[2 * r + 1], rows[r].digits_.data());
+                rows[r].remove_leading_zeros();
+            }
+            for (size_t c = 0; c < st.columns; c++) {
+                BigInt first = st.u[0][c] * t[0];
+                first += st.u[1][c] * t[1];
+                BigInt second = st.u[0][c] * t[2];
+                second += st.u[1][c] * t[3];
+                st.u[0][c] = std::move(first);
+                st.u[1][c] = std::move(second);
+            }
+            st.a = std::move(rows[0]);
+            st.b = std::move(rows[1]);
+            //certain steps keep a >= b >= 0, the checks only guard the invariant
+            for (int r = 0; r < 2; r++) {
+                BigInt & value = r == 0 ? st.a : st.b;
+                if (value.isNegative_ == true) {
+                    value.isNegative_ = false;
+                    for (size_t c = 0; c < st.columns; c++) {
+                        st.u[r][c] = -st.u[r][c];
+                    }
+                }
+            }
+            if (st.a < st.b) {
+                std::swap(st.a, st.b);
+                for (size_t c = 0; c < st.columns; c++) {
+                    std::swap(st.u[0][c], st.u[1][c]);
+                }
+            }
+        }
+
+        void BigInt::transform(BigInt::euclid_state & st, const BigInt (&m)[2][2]) {
+            BigInt first = m[0][0] * st.a + m[0][1] * st.b;
+            BigInt second = m[1][0] * st.a + m[1][1] * st.b;
+            st.a = std::move(first);
+            st.b = std::move(second);
+            for (size_t c = 0; c < st.columns; c++) {
+                first = m[0][0] * st.u[0][c] + m[0][1] * st.u[1][c];
+                second = m[1][0] * st.u[0][c] + m[1][1] * st.u[1][c];
+                st.u[0][c] = std::move(first);
+                st.u[1][c] = std::move(second);
+            }
+            //a matrix from the leading parts may end one step off, the rows are put back in order
+            for (int r = 0; r < 2; r++) {
+                BigInt & value = r == 0 ? st.a : st.b;
+                if (value.isNegative_ == true) {
+                    value.isNegative_ = false;
+                    for (size_t c = 0; c < st.columns; c++) {
+                        st.u[r][c] = -st.u[r][c];
+                    }
+                }
+            }
+            if (st.a < st.b) {
+                std::swap(st.a, st.b);
+                for (size_t c = 0; c < st.columns; c++) {
+                    std::swap(st.u[0][c], st.u[1][c]);
+                }
+            }
+        }
+
+        void BigInt::division_step(BigInt::euclid_state & st) {
+            std::pair<BigInt, BigInt> qr = divmod(st.a, st.b);
+            st.a = std::move(st.b);
+            st.b = std::move(qr.second);
+            for (size_t c = 0; c < st.columns; c++) {
+                BigInt next = st.u[0][c] - qr.first * st.u[1][c];
+                st.u[0][c] = std::move(st.u[1][c]);
+                st.u[1][c] = std::move(next);
+            }
+        }
+
+        void BigInt::half_gcd(const BigInt & a, const BigInt & b, BigInt (&m)[2][2]) {
+            BigInt::euclid_state st;
+            st.a = a;
+            st.b = b;
+            st.columns = 2;
+            st.u[0][0] = 1;
+            st.u[1][1] = 1;
+            size_t n = a.bit_length(), s = n / 2 + 1;
+            while (st.b.bit_length() > s) {
+                //the half-gcd of the leading 2 * (bits(a) - s) bits brings a down to about s bits
+                size_t na = st.a.bit_length();
+                size_t high = std::min(2 * (na - s), n / 2 + 1);
+                bool identity = true;
+                if (high < BigInt::half_gcd_threshold_ * 64) {
+                    int64_t t[4];
+                    BigInt::lehmer_matrix(st.a, st.b, s, t);
+                    identity = t[1] == 0;
+                    if (identity == false) {
+                        BigInt::transform(st, t);
+                    }
+                }
+                else {
+                    BigInt t[2][2];
+                    BigInt::half_gcd(st.a >> (na - high), st.b >> (na - high), t);
+                    identity = t[0][1] == 0 && t[1][0] == 0;
+                    if (identity == false) {
+                        BigInt::transform(st, t);
+                    }
+                }
+                if (identity == true) {
+                    BigInt::division_step(st);
+                }
+            }
+            for (int i = 0; i < 2; i++) {
+                for (int j = 0; j < 2; j++) {
+                    m[i][j] = std::move(st.u[i][j]);
+                }
+            }
+        }
+
+        void BigInt::euclid(BigInt::euclid_state & st) {
+            while (st.b != 0) {
+                size_t na = st.a.bit_length(), nb = st.b.bit_length();
+                bool identity = true;
+                if (na - nb < 62 && st.b.digits_.size() >= BigInt::half_gcd_threshold_) {
+                    BigInt t[2][2];
+                    BigInt::half_gcd(st.a, st.b, t);
+                    identity = t[0][1] == 0 && t[1][0] == 0;
+                    if (identity == false) {
+                        BigInt::transform(st, t);
+                    }
+                }
+                else if (na - nb < 62) {
+                    int64_t t[4];
+                    BigInt::lehmer_matrix(st.a, st.b, 0, t);
+                    identity = t[1] == 0;
+                    if (identity == false) {
+                        BigInt::transform(st, t);
+                    }
+                }
+                if (identity == true) {
+                    BigInt::division_step(st);
+                }
+            }
+        }
+
+        BigInt gcd(const BigInt & first, const BigInt & second) {
+            BigInt::euclid_state st;
+            st.a = first;
+            st.b = second;
+            st.a.isNegative_ = false;
+            st.b.isNegative_ = false;
+            st.columns = 0;
+            if (st.a < st.b) {
+                std::swap(st.a, st.b);
+            }
+            BigInt::euclid(st);
+            return st.a;
+        }
+
+        std::tuple<BigInt, BigInt, BigInt> xgcd(const BigInt & first, const BigInt & second) {
+            //only the cofactor of |first| is tracked, the other one follows from the result
+            BigInt::euclid_state st;
+            st.a = first;
+            st.b = second;
+            st.a.isNegative_ = false;
+            st.b.isNegative_ = false;
+            st.columns = 1;
+            st.u[0][0] = 1;
+            if (st.a < st.b) {
+                std::swap(st.a, st.b);
+                std::swap(st.u[0][0], st.u[1][0]);
+            }
+            BigInt::euclid(st);
+            BigInt g = std::move(st.a), x = std::move(st.u[0][0]), y;
+            if (second != 0) {
+                BigInt magnitude = second;
+                magnitude.isNegative_ = false;
+                BigInt a = first;
+                a.isNegative_ = false;
+                y = (g - x * a) / magnitude;
+            }
+            else if (first == 0) {
+                x = 0;
+            }
+            if (first.isNegative_ == true) {
+                x = -x;
+            }
+            if (second.isNegative_ == true) {
+                y = -y;
+            }
+            return std::tuple<BigInt, BigInt, BigInt>(std::move(g), std::move(x), std::move(y));
+        }
+
+        BigInt modinv(const BigInt & value, const BigInt & mod) {
+            if (mod == 0) {
+                throw BigInt::divide_by_zero();
+            }
+            BigInt modulus = mod;
+            modulus.isNegative_ = false;
+            std::tuple<BigInt, BigInt, BigInt> result = xgcd(value % modulus, modulus);
+            if (std::get<0>(result) != 1) {
+                //the only residue modulo one is zero, and it is its own inverse
+                if (modulus == 1) {
+                    return BigInt();
+                }
+                throw BigInt::invalid_argument();
+            }
+            return std::get<1>(result) % modulus;
+        }
+
+        std::pair<BigInt, BigInt> sqrtrem(const BigInt & value) {
+            if (value < 0) {
+                throw BigInt::invalid_argument();
+            }
+            size_t bits = value.bit_length();
+            if (bits <= 120) {
+                //a double is close enough, the integer square fixes the last units
+                unsigned __int128 x = value.top_bits(0);
+                uint64_t s = static_cast<uint64_t>(std::sqrt(static_cast<double>(x)));
+                while (static_cast<unsigned __int128>(s) * s > x) {
+                    s--;
+                }
+                while (static_cast<unsigned __int128>(s + 1) * (s + 1) <= x) {
+                    s++;
+                }
+                uint64_t r = static_cast<uint64_t>(x - static_cast<unsigned __int128>(s) * s);
+                return {BigInt::from_limbs(&s, 1), BigInt::from_limbs(&r, 1)};
+            }
+            //s0 = isqrt(x / 4^k) * 2^k is below the root by less than 2^k
+            //one newton step from there lands at most a few units above it
+            size_t k = bits / 4 - 1;
+            BigInt root = sqrtrem(value >> 2 * k).first << k;
+            root += value / root;
+            root >>= 1;
+            BigInt remainder = value - square(root);
+            while (remainder < 0) {
+                remainder += root + root - 1;
+                root -= 1;
+            }
+            return {std::move(root), std::move(remainder)};
+        }
+
+        BigInt isqrt(const BigInt & value) {
+            return sqrtrem(value).first;
+        }
+
+        BigInt iroot(const BigInt & value, uint64_t n) {
+            if (n == 0 || (value < 0 && n % 2 == 0)) {
+                throw BigInt::invalid_argument();
+            }
+            if (value < 0) {
+                return -iroot(-value, n);
+            }
+            if (n == 1 || value <= 1) {
+                return value;
+            }
+            if (n == 2) {
+                return isqrt(value);
+            }
+            size_t bits = value.bit_length();
+            if (n >= bits) {
+                return BigInt(1);
+            }
+            //a starting point above the root
+            BigInt root;
+            if (bits / n <= 50) {
+                //short roots from the logarithm of the leading bits
+                size_t shift = bits > 64 ? bits - 64 : 0;
+                double top = static_cast<double>(static_cast<uint64_t>(value.top_bits(shift)));
+                double estimate = std::exp2((std::log2(top) + shift) / n);
+                uint64_t start = static_cast<uint64_t>(estimate * (1 + 1e-9)) + 2;
+                root = BigInt::from_limbs(&start, 1);
+            }
+            else {
+                //the root of the leading bits, precise to about half of the root's bits
+                size_t k = bits / (2 * n);
+                root = (iroot(value >> n * k, n) + 1) << k;
+            }
+            //newton's iteration decreases from above to the root and stops there
+            while (true) {
+                BigInt next = (root * (n - 1) + value / pow(root, n - 1)) / n;
+                if (next >= root) {
+                    return root;
+                }
+                root = std::move(next);
+            }
         }
 
-        BigInt operator-(const BigInt & first, const BigInt & second) {
-            //(-a) - (b) --> -(a + b)
-            if (first.isNegative_ == true && second.isNegative_ == false) {
-                return (-((-first) + second));
+        bool BigInt::is_odd_power(const BigInt & x, uint64_t p) {
+            size_t bits = x.bit_length();
+            if ((bits + p - 1) / p <= 64) {
+                //a root of up to 64 bits is the unique p-th root of x modulo 2^64, x^d with d * p = 1 modulo 2^62
+                uint64_t d = p;
+                for (int i = 0; i < 5; i++) {
+                    d *= 2 - p * d;
+                }
+                uint64_t root = 1, base = x.digits_[0];
+                for (; d != 0; d >>= 1) {
+                    if (d & 1) {
+                        root *= base;
+                    }
+                    base *= base;
+                }
+                //root^p has between (length - 1) * p + 1 and length * p bits
+                size_t length = 64 - __builtin_clzll(root);
+                if (bits <= (length - 1) * p || bits > length * p) {
+                    return false;
+                }
+                return pow(BigInt::from_limbs(&root, 1), p) == x;
+            }
+            //x is a p-th power residue modulo the primes q = 2kp + 1, a non-power passes each of them with chance 1/p
+            int tests = 0;
+            for (uint64_t q = 2 * p + 1; tests < 4 && q < (1ULL << 32); q += 2 * p) {
+                bool prime = true;
+                for (uint64_t d = 3; d * d <= q && prime; d += 2) {
+                    prime = q % d != 0;
+                }
+                if (prime == false) {
+                    continue;
+                }
+                tests++;
+                uint64_t r = 0;
+                for (size_t i = x.digits_.size(); i-- > 0;) {
+                    r = (r << 32 | x.digits_[i] >> 32) % q;
+                    r = (r << 32 | (x.digits_[i] & 0xffffffff)) % q;
+                }
+                uint64_t power = 1;
+                for (uint64_t e = (q - 1) / p, base = r; e != 0; e >>= 1) {
+                    if (e & 1) {
+                        power = power * base % q;
+                    }
+                    base = base * base % q;
+                }
+                if (r != 0 && power != 1) {
+                    return false;
+                }
             }
-            //(a) - (-b) --> (a) + (b)
-            else if (second.isNegative_ == true && first.isNegative_ == false) {
-                return (first + (-second));
+            return pow(iroot(x, p), p) == x;
+        }
+
+        bool is_perfect_power(const BigInt & value) {
+            if (value >= -1 && value <= 1) {
+                return true;
             }
-            //(a) - (b) && b > a --> -(b - a)
-            else if (first < second) {
-                return (-(second - first));
+            //|x| = 2^twos * odd is a p-th power if p divides twos and odd is a p-th power
+            BigInt odd = value;
+            odd.isNegative_ = false;
+            size_t zero_limbs = 0;
+            while (odd.digits_[zero_limbs] == 0) {
+                zero_limbs++;
             }
-            else {
-                BigInt result;
-                long long int min_size, max_size;
-                BigInt mmax, mmin;
-                if (first > second) {
-                    min_size = second.digits_.size(), max_size = first.digits_.size();
-                    mmax = first;
-                    mmin = second;
+            size_t twos = zero_limbs * 64 + __builtin_ctzll(odd.digits_[zero_limbs]);
+            odd >>= twos;
+            size_t bits = std::max(odd.bit_length(), twos);
+            //prime exponents are enough, y^(p * q) = (y^q)^p
+            for (uint64_t p = 2; p <= bits; p++) {
+                bool prime = true;
+                for (uint64_t d = 2; d * d <= p && prime; d++) {
+                    prime = p % d != 0;
                 }
-                else {
-                    max_size = second.digits_.size(), min_size = first.digits_.size();
-                    mmax = second;
-                    mmin = first;
+                if (prime == false || twos % p != 0 || (value < 0 && p == 2)) {
+                    continue;
                 }
-                result = mmax;
-                int borrowed_num = 0;
-                for (long long int i = 0; i < min_size || borrowed_num != 0; i++) {
-                    result.digits_[i] -= borrowed_num + (i < min_size ? mmin.digits_[i] : 0);
-                    borrowed_num = result.digits_[i] < 0;
-                    if (borrowed_num != 0) result.digits_[i] += BigInt::base_;
+                if (odd == 1) {
+                    return true;
+                }
+                //odd squares are 1 modulo 8
+                if (p == 2 ? (odd.digits_[0] & 7) == 1 && sqrtrem(odd).second == 0 : BigInt::is_odd_power(odd, p)) {
+                    return true;
                 }
-                result.remove_leading_zeros();
-                return result;
             }
+            return false;
         }
-        
-        BigInt operator*(const BigInt & first, const BigInt & second) {
-            BigInt result;
-            if (first == result || second == result) {
-                return result;
+
+        std::vector<uint64_t> BigInt::primes_up_to(uint64_t n) {
+            std::vector<uint64_t> primes;
+            if (n < 2) {
+                return primes;
             }
-            long long int min_size, max_size;
-            BigInt mmax, mmin;
-            if (first >= second) {
-                min_size = second.digits_.size();
-                max_size = first.digits_.size();
-                mmax = first;
-                mmin = second;
-            }
-            else if (second > first) {
-                max_size = second.digits_.size();
-                min_size = first.digits_.size();
-                mmax = second;
-                mmin = first;
-            }
-            result.digits_.resize(first.digits_.size() + second.digits_.size());
-            for (long long int j = 0; j < min_size; j++) {
-                int carry = 0;
-                for (long long int i = 0; i < max_size || carry != 0; i++) {
-                    long long int res = static_cast<long long int>(mmax.digits_[i]) *
-                    static_cast<long long int>(mmin.digits_[j]) + carry;
-                    int reminder = res % BigInt::base_;
-                    carry = res / BigInt::base_;
-                    result.digits_[i + j] += reminder;
+            primes.push_back(2);
+            //composite[i] marks 2i + 1
+            std::vector<bool> composite(n / 2 + 1);
+            for (uint64_t i = 1; 2 * i + 1 <= n; i++) {
+                if (composite[i]) {
+                    continue;
+                }
+                uint64_t p = 2 * i + 1;
+                primes.push_back(p);
+                for (uint64_t j = p * p / 2; p <= n / p && j <= n / 2; j += p) {
+                    composite[j] = true;
                 }
             }
-            if (first.isNegative_ == second.isNegative_) {
-                result.isNegative_ = false;
+            return primes;
+        }
+
+        BigInt BigInt::product_tree(const uint64_t * f, size_t n) {
+            if (n > 16) {
+                return BigInt::product_tree(f, n / 2) * BigInt::product_tree(f + n / 2, n - n / 2);
             }
-            else if (first.isNegative_ != second.isNegative_) {
-                result.isNegative_ = true;
+            BigInt result(1);
+            uint64_t limb = 1;
+            for (size_t i = 0; i < n; i++) {
+                unsigned __int128 cur = static_cast<unsigned __int128>(limb) * f[i];
+                if (cur >> 64 != 0) {
+                    result.mul_small(limb, false);
+                    limb = f[i];
+                }
+                else {
+                    limb = static_cast<uint64_t>(cur);
+                }
             }
-            result.remove_leading_zeros();
+            result.mul_small(limb, false);
             return result;
         }
 
-        BigInt operator/(const BigInt & first, const BigInt & second) {
-           BigInt result;
-            if (second == result) {
+        BigInt BigInt::from_prime_powers(const std::vector<uint64_t> & primes, const std::vector<uint64_t> & exponents) {
+            uint64_t top = 0;
+            for (uint64_t e : exponents) {
+                top |= e;
+            }
+            BigInt result(1);
+            std::vector<uint64_t> factors;
+            for (int bit = top == 0 ? -1 : 63 - __builtin_clzll(top); bit >= 0; bit--) {
+                result = square(result);
+                factors.clear();
+                for (size_t i = 0; i < primes.size(); i++) {
+                    if (exponents[i] >> bit & 1) {
+                        factors.push_back(primes[i]);
+                    }
+                }
+                if (factors.empty() == false) {
+                    result *= BigInt::product_tree(factors.data(), factors.size());
+                }
+            }
+            return result;
+        }
+
+        BigInt factorial(uint64_t n) {
+            //the power of two is n minus the number of ones in n, the odd primes go through the exponent bits
+            std::vector<uint64_t> primes = BigInt::primes_up_to(n);
+            std::vector<uint64_t> exponents(primes.size());
+            for (size_t i = 1; i < primes.size(); i++) {
+                for (uint64_t q = n / primes[i]; q != 0; q /= primes[i]) {
+                    exponents[i] += q;
+                }
+            }
+            return BigInt::from_prime_powers(primes, exponents) << static_cast<size_t>(n - __builtin_popcountll(n));
+        }
+
+        BigInt binomial(uint64_t n, uint64_t k) {
+            if (k > n) {
+                return BigInt();
+            }
+            k = std::min(k, n - k);
+            if (k < n / 64) {
+                //a sieve up to n costs more than the k factors of the numerator
+                std::vector<uint64_t> numerator(k);
+                for (uint64_t i = 0; i < k; i++) {
+                    numerator[i] = n - i;
+                }
+                return BigInt::product_tree(numerator.data(), numerator.size()) / factorial(k);
+            }
+            //the exponent of p is the number of borrows when subtracting k from n in base p
+            std::vector<uint64_t> primes = BigInt::primes_up_to(n);
+            std::vector<uint64_t> exponents(primes.size());
+            for (size_t i = 1; i < primes.size(); i++) {
+                uint64_t p = primes[i];
+                for (uint64_t a = n / p, b = k / p, c = (n - k) / p; a != 0; a /= p, b /= p, c /= p) {
+                    exponents[i] += a - b - c;
+                }
+            }
+            size_t twos = __builtin_popcountll(k) + __builtin_popcountll(n - k) - __builtin_popcountll(n);
+            return BigInt::from_prime_powers(primes, exponents) << twos;
+        }
+
+        BigInt primorial(uint64_t n) {
+            std::vector<uint64_t> primes = BigInt::primes_up_to(n);
+            return BigInt::product_tree(primes.data(), primes.size());
+        }
+
+        BigInt powmod(const BigInt & base, const BigInt & exp, const BigInt & mod) {
+            if (mod == 0) {
                 throw BigInt::divide_by_zero();
-            }    
-            if (first < second && first.isNegative_ == second.isNegative_) {
-                return result;
             }
-            if (second == (BigInt)1) {
-                return first;
+            if (exp < 0) {
+                throw BigInt::invalid_argument();
+            }
+            BigInt modulus = mod;
+            modulus.isNegative_ = false;
+            if ((modulus.digits_[0] & 1) == 1) {
+                thread_local std::unique_ptr<BigInt::montgomery> context;
+                if (context == nullptr || context->modulus() != modulus) {
+                    context.reset(new BigInt::montgomery(modulus));
+                }
+                std::vector<uint64_t> power(context->size());
+                context->to_montgomery(base, power.data());
+                context->pow(power.data(), exp, power.data());
+                return context->from_montgomery(power.data());
             }
-            if (second == (BigInt)-1) {
-                return -first;
+            //even moduli reduce by a precomputed reciprocal instead
+            BigInt::reciprocal reciprocal(modulus);
+            BigInt b = reciprocal.remainder(base);
+            BigInt result = reciprocal.remainder(BigInt(1));
+            for (size_t i = exp.bit_length(); i > 0; i--) {
+                result = reciprocal.remainder(square(result));
+                if ((exp.digits_[(i - 1) / 64] >> (i - 1) % 64 & 1) == 1) {
+                    result = reciprocal.remainder(result * b);
+                }
             }
+            return result;
+        }
 
-            long long int size = first.digits_.size() - 1;
-            BigInt chunck = first.digits_[size];
-            for ( ; size >= 0; ) {
-                while (chunck < second) {
-                    auto begin = chunck.digits_.begin();
-                    int num = first.digits_[--size];
-                    chunck.digits_.insert(begin, num);
+        std::pair<BigInt, BigInt> divmod(const BigInt & first, const BigInt & second) {
+            BigInt q, r;
+            if (second == q) {
+                throw BigInt::divide_by_zero();
+            }
+            if (second.digits_.size() >= BigInt::newton_threshold_ &&
+                first.digits_.size() >= second.digits_.size() + BigInt::newton_threshold_) {
+                //the reciprocal of the last divisor is kept per thread, dividing by it again skips newton's iteration
+                //it is built for |second|, the sign of the quotient is fixed afterwards
+                thread_local std::unique_ptr<BigInt::reciprocal> last;
+                if (last == nullptr || BigInt::compare_limbs(last->divisor().digits_.data(), last->divisor().digits_.size(),
+                                                             second.digits_.data(), second.digits_.size()) != 0) {
+                    BigInt magnitude = second;
+                    magnitude.isNegative_ = false;
+                    last.reset(new BigInt::reciprocal(magnitude));
                 }
-                while (chunck >= second) {
-                    chunck -= second;
-                    result += 1;
+                std::pair<BigInt, BigInt> result = last->divmod(first);
+                if (second.isNegative_ == true) {
+                    result.first *= -1;
                 }
-                if (size == 0) break;
+                return result;
             }
+            BigInt::div_limbs(first.digits_, second.digits_, q.digits_, r.digits_);
             if (first.isNegative_ == second.isNegative_) {
-                result.isNegative_ = false; 
+                q.isNegative_ = false;
             }
             else {
-                result.isNegative_ = true;
+                q.isNegative_ = true;
             }
-            return result;
+            q.remove_leading_zeros();
+            r.remove_leading_zeros();
+            //the remainder is never negative: |second| - r for negative dividends
+            if (first.isNegative_ == true && r != BigInt()) {
+                BigInt divisor = second;
+                divisor.isNegative_ = false;
+                r = divisor - r;
+            }
+            return std::make_pair(q, r);
+        }
+
+        BigInt operator/(const BigInt & first, const BigInt & second) {
+            return divmod(first, second).first;
         }
 
         BigInt operator%(const BigInt & first, const BigInt & second) {
-            BigInt result = first - (first/second) * second;
-            if (result.isNegative_ == true) {
-                result += second;
-            }
-            return result;
+            return divmod(first, second).second;
         }
 
         bool BigInt::operator==(const BigInt & big_int) const {
             if (this->isNegative_ != big_int.isNegative_) {
                 return false;
             }
-            if (this->digits_ == big_int.digits_) return true;
-            else return false;
+            return BigInt::compare_limbs(this->digits_.data(), this->digits_.size(),
+                big_int.digits_.data(), big_int.digits_.size()) == 0;
         }
 
         bool BigInt::operator!=(const BigInt & big_int) const {
@@ -524,29 +4270,12 @@ class BigInt {
         }
 
         bool BigInt::operator<(const BigInt & big_int) const {
-            if (*this == big_int) {
-                return false;
-            }
-            if (this->isNegative_ == true && big_int.isNegative_ == false) {
-                return true;
-            }
-            else if (this->isNegative_ == false && big_int.isNegative_ == true) {
-                return false;
-            }
-            if ((this->digits_.size() < big_int.digits_.size()) && (this->isNegative_ == big_int.isNegative_)) {
-                return true;
-            }
-            else if ((this->digits_.size() > big_int.digits_.size()) && (this->isNegative_ == big_int.isNegative_)) {
-                return false;
-            }
-            else if ((this->digits_.size() == big_int.digits_.size()) && (this->isNegative_ == big_int.isNegative_)){
-                for (long long int i = this->digits_.size() - 1; i >= 0; i--) {
-                    if (this->digits_[i] > big_int.digits_[i]) {
-                        return false;
-                    }
-                }
+            if (this->isNegative_ != big_int.isNegative_) {
+                return this->isNegative_;
             }
-            return true;
+            int cmp = BigInt::compare_limbs(this->digits_.data(), this->digits_.size(),
+                big_int.digits_.data(), big_int.digits_.size());
+            return this->isNegative_ ? cmp > 0 : cmp < 0;
         }
 
         bool BigInt::operator>(const BigInt & big_int) const {
@@ -561,180 +4290,119 @@ class BigInt {
             return (big_int <= *this);
         }
 
-        std::string BigInt::binary(BigInt big_int) const {
-            std::string bin;
-            BigInt tmp(big_int);
-            tmp.isNegative_ = false;
-            BigInt zero;
-            while (tmp > zero) {
-                int modulo = tmp % (BigInt)2;
-                bin.insert(bin.begin(), modulo + '0');
-                tmp /= (BigInt)2;
-            }
-            bin.insert(bin.begin(), '0'); //sign bit
-            if (big_int.isNegative_ == true) {
-                for (long long int i = 0; i < bin.size(); i++) {
-                    bin[i] = (bin[i] == '0' ? '1' : '0');
-                }
-                auto bit = bin.end() - 1;
-                while (*bit == '1') { //adding 1 bit to the end
-                    *bit = '0';
-                    if (bit == bin.begin()) {
-                        bin.insert(bin.begin(), '1'); //sign bit
-                        return bin;
-                    }
-                    bit--;
+        BigInt::limb_vector BigInt::twos_complement(size_t n) const {
+            BigInt::limb_vector result(this->digits_);
+            result.resize(n, 0);
+            if (this->isNegative_ == true) {
+                //-x = ~(x - 1)
+                uint64_t one = 1;
+                BigInt::sub_limbs(result.data(), n, &one, 1);
+                for (size_t i = 0; i < n; i++) {
+                    result[i] = ~result[i];
                 }
-                *bit = '1'; 
             }
-            return bin;
+            return result;
         }
 
-        BigInt BigInt::decimal(std::string bin) const {
+        BigInt BigInt::from_twos_complement(BigInt::limb_vector & limbs) {
             BigInt result;
-            long long int place = 1;
-            for (auto bit = bin.end() - 1; bit > bin.begin(); bit--) {
-                if (*bit == '1') {
-                    result += (BigInt)place;
+            result.isNegative_ = (limbs.back() >> 63) != 0;
+            if (result.isNegative_ == true) {
+                //|x| = ~x + 1
+                for (size_t i = 0; i < limbs.size(); i++) {
+                    limbs[i] = ~limbs[i];
                 }
-                place *= 2;
-            }
-            if (*(bin.begin()) == '0') {
-                result.isNegative_ = false;
-            }
-            else {
-                result.isNegative_ = true;
+                uint64_t one = 1;
+                BigInt::add_limbs(limbs.data(), limbs.size(), &one, 1);
             }
+            result.digits_.swap(limbs);
+            result.remove_leading_zeros();
             return result;
         }
 
         BigInt BigInt::operator~() const {
-            std::string bin = binary(*this);
-            for (auto bit = bin.end() - 1; bit >= bin.begin(); bit--) {
-                *bit = ((*bit) == '0' ? '1' : '0');
-            }
-            BigInt result = decimal(bin);
+            //~x = -x - 1
+            BigInt result = -*this;
+            result -= 1;
             return result;
         }
 
         BigInt operator^(const BigInt & first, const BigInt & second) {
-            std::string bin1 = first.binary(first);
-            std::string bin2 = second.binary(second);
-            std::string result_str;
-            std::string mmax, mmin;
-            if (bin1.size() >= bin2.size()) {
-                mmax = bin1, mmin = bin2;
-            }
-            else if (bin1.size() < bin2.size()) {
-                mmax = bin2, mmin = bin1;
-            }
-            if (mmin.size() < mmax.size()) {
-                char sign = mmin[0];
-                mmin.pop_back();
-                while (mmin.size() < mmax.size() - 1) {
-                    mmin.insert(mmin.begin(), '0');
-                }
-                mmin.insert(mmin.begin(), sign);
-            }
-            for (long long int i = mmin.size() - 1; i > 0 ; i--) {
-                if (mmax[i] != mmin[i]) {
-                    result_str.insert(result_str.begin(), '1');
-                }
-                else if (mmax[i] == mmin[i]) {
-                    result_str.insert(result_str.begin(), '0');
-                }
-            }
-            //define sign
-            if (mmax[0] != mmin[0]) {
-                result_str.insert(result_str.begin(), '1');
-            }
-            else {
-                result_str.insert(result_str.begin(), '0');
-            }
-            BigInt result = result.decimal(result_str);
-            return result;
+            return BigInt::bitwise(first, second, [](uint64_t a, uint64_t b) { return a ^ b; });
         }
        
         BigInt operator&(const BigInt & first, const BigInt & second) {
-            std::string bin1 = first.binary(first);
-            std::string bin2 = second.binary(second);
-            std::string result_str;
-            std::string mmax, mmin;
-            if (bin1.size() >= bin2.size()) {
-                mmax = bin1, mmin = bin2;
-            }
-            else if (bin1.size() < bin2.size()) {
-                mmax = bin2, mmin = bin1;
+            return BigInt::bitwise(first, second, [](uint64_t a, uint64_t b) { return a & b; });
+        }
+        
+        BigInt operator|(const BigInt & first, const BigInt & second) {
+            return BigInt::bitwise(first, second, [](uint64_t a, uint64_t b) { return a | b; });
+        }
+
+        template <typename T, typename>
+        BigInt BigInt::operator<<(T shift) const {
+            if (shift < 0) {
+                throw BigInt::invalid_argument();
             }
-            if (mmin.size() < mmax.size()) {
-                char sign = mmin[0];
-                mmin.pop_back();
-                while (mmin.size() < mmax.size() - 1) {
-                    mmin.insert(mmin.begin(), '0');
-                }
-                mmin.insert(mmin.begin(), sign);
+            return BigInt::shift_left(*this, static_cast<size_t>(shift));
+        }
+
+        template <typename T, typename>
+        BigInt BigInt::operator>>(T shift) const {
+            if (shift < 0) {
+                throw BigInt::invalid_argument();
             }
-            for (long long int i = mmin.size() - 1; i > 0 ; i--) {
-                if (mmax[i] == '1' && mmin[i] == '1') {
-                    result_str.insert(result_str.begin(), '1');
-                }
-                else {
-                    result_str.insert(result_str.begin(), '0');
+            return BigInt::shift_right(*this, static_cast<size_t>(shift));
+        }
+
+        BigInt BigInt::shift_left(const BigInt & big_int, size_t shift) {
+            size_t limbs = shift / 64, bits = shift % 64;
+            BigInt result;
+            result.digits_.assign(big_int.digits_.size() + limbs + 1, 0);
+            for (size_t i = 0; i < big_int.digits_.size(); i++) {
+                result.digits_[i + limbs] |= big_int.digits_[i] << bits;
+                if (bits != 0) {
+                    result.digits_[i + limbs + 1] = big_int.digits_[i] >> (64 - bits);
                 }
             }
-            //define sign
-            if (mmax[0] == '1' && mmin[0] == '1') {
-                result_str.insert(result_str.begin(), '1');
-            }
-            else {
-                result_str.insert(result_str.begin(), '0');
-            }
-            BigInt result = result.decimal(result_str);
+            result.isNegative_ = big_int.isNegative_;
+            result.remove_leading_zeros();
             return result;
         }
-        
-        BigInt operator|(const BigInt & first, const BigInt & second) {
-            std::string bin1 = first.binary(first);
-            std::string bin2 = second.binary(second);
-            std::string result_str;
-            std::string mmax, mmin;
-            if (bin1.size() >= bin2.size()) {
-                mmax = bin1, mmin = bin2;
-            }
-            else if (bin1.size() < bin2.size()) {
-                mmax = bin2, mmin = bin1;
+
+        BigInt BigInt::shift_right(const BigInt & big_int, size_t shift) {
+            size_t limbs = shift / 64, bits = shift % 64;
+            BigInt result;
+            if (limbs >= big_int.digits_.size()) {
+                //every bit is shifted out: 0 or -1
+                return big_int.isNegative_ ? BigInt(-1) : result;
             }
-            if (mmin.size() < mmax.size()) {
-                char sign = mmin[0];
-                mmin.pop_back();
-                while (mmin.size() < mmax.size() - 1) {
-                    mmin.insert(mmin.begin(), '0');
+            size_t n = big_int.digits_.size() - limbs;
+            result.digits_.assign(n, 0);
+            for (size_t i = 0; i < n; i++) {
+                result.digits_[i] = big_int.digits_[i + limbs] >> bits;
+                if (bits != 0 && i + 1 < n) {
+                    result.digits_[i] |= big_int.digits_[i + limbs + 1] << (64 - bits);
                 }
-                mmin.insert(mmin.begin(), sign);
             }
-            std::cout << mmax << std::endl << mmin << std::endl;
-            for (long long int i = mmin.size() - 1; i > 0 ; i--) {
-                if (mmax[i] == '0' && mmin[i] == '0') {
-                    result_str.insert(result_str.begin(), '0');
+            result.isNegative_ = big_int.isNegative_;
+            if (big_int.isNegative_ == true) {
+                //round toward negative infinity if any shifted out bit is set
+                bool inexact = bits != 0 && (big_int.digits_[limbs] << (64 - bits)) != 0;
+                for (size_t i = 0; i < limbs && !inexact; i++) {
+                    inexact = big_int.digits_[i] != 0;
                 }
-                else {
-                    result_str.insert(result_str.begin(), '1');
+                if (inexact == true) {
+                    result -= 1;
                 }
             }
-            //define sign
-            if (mmax[0] == '0' && mmin[0] == '0') {
-                result_str.insert(result_str.begin(), '0');
-            }
-            else {
-                result_str.insert(result_str.begin(), '1');
-            }
-            std::cout << result_str << std::endl;
-            BigInt result = result.decimal(result_str);
+            result.remove_leading_zeros();
             return result;
         }
 
         BigInt & BigInt::operator+=(const BigInt & big_int) {
-            return *this = *this + big_int;
+            this->add_signed(big_int.digits_.data(), big_int.digits_.size(), big_int.isNegative_);
+            return *this;
         }
 
         BigInt & BigInt::operator*=(const BigInt & big_int) {
@@ -742,15 +4410,17 @@ class BigInt {
         }
 
         BigInt & BigInt::operator-=(const BigInt & big_int) {
-            return *this = *this - big_int;
+            //zero is never negative, so a zero operand adds nothing in either case
+            this->add_signed(big_int.digits_.data(), big_int.digits_.size(), !big_int.isNegative_);
+            return *this;
         }
 
         BigInt & BigInt::operator/=(const BigInt & big_int) {
-            return *this = *this / big_int;
+            return *this = divmod(*this, big_int).first;
         }
 
         BigInt & BigInt::operator%=(const BigInt & big_int) {
-            return *this = *this % big_int;
+            return *this = divmod(*this, big_int).second;
         }
 
         BigInt & BigInt::operator^=(const BigInt & big_int) {
@@ -762,4 +4432,230 @@ class BigInt {
         BigInt & BigInt::operator|=(const BigInt & big_int) {
             return *this = *this | big_int;
         }
+        BigInt & BigInt::operator<<=(size_t shift) {
+            return *this = *this << shift;
+        }
+        BigInt & BigInt::operator>>=(size_t shift) {
+            return *this = *this >> shift;
+        }
+
+        BigInt::lazy_leaf BigInt::lazy(const BigInt & value) {
+            return BigInt::lazy_leaf(value);
+        }
+
+        BigInt::lazy_leaf::lazy_leaf(const BigInt & value) {
+            this->value_ = &value;
+        }
+
+        void BigInt::lazy_leaf::collect(BigInt::lazy_terms & terms, bool negative) const {
+            terms.add(this->value_, nullptr, negative);
+        }
+
+        const BigInt & BigInt::lazy_leaf::materialize(BigInt::lazy_terms &) const {
+            return *this->value_;
+        }
+
+        BigInt::lazy_terms::lazy_terms(size_t count) {
+            this->terms_.reserve(count);
+        }
+
+        void BigInt::lazy_terms::add(const BigInt * left, const BigInt * right, bool negative) {
+            this->terms_.push_back({left, right, negative});
+        }
+
+        BigInt & BigInt::lazy_terms::temporary() {
+            this->temporaries_.emplace_back();
+            return this->temporaries_.back();
+        }
+
+        bool BigInt::lazy_terms::refers_to(const BigInt * value) const {
+            for (const term & t : this->terms_) {
+                if (t.left == value || t.right == value) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void BigInt::lazy_terms::evaluate(BigInt & value) const {
+            //no term is longer than its operands together, spare limbs for the carries
+            size_t size = 1;
+            for (const term & t : this->terms_) {
+                size = std::max(size, t.left->digits_.size() + (t.right ? t.right->digits_.size() : 0));
+            }
+            value.digits_.assign(1, 0);
+            value.isNegative_ = false;
+            value.digits_.reserve(size + 2);
+            for (const term & t : this->terms_) {
+                if (t.right == nullptr) {
+                    value.add_signed(t.left->digits_.data(), t.left->digits_.size(), t.left->isNegative_ != t.negative);
+                }
+                else {
+                    value.add_product(*t.left, *t.right, t.negative);
+                }
+            }
+        }
+
+        ModContext::ModContext(const BigInt & modulus) : montgomery_(std::make_shared<BigInt::montgomery>(modulus)) {
+        }
+
+        const BigInt & ModContext::modulus() const {
+            return this->montgomery_->modulus();
+        }
+
+        ModInt ModContext::operator()(const BigInt & x) const {
+            return ModInt(*this, x);
+        }
+
+        ModInt::ModInt() {
+        }
+
+        ModInt::ModInt(const ModContext & context, const BigInt & x)
+            : context_(context.montgomery_), limbs_(context.montgomery_->size()) {
+            this->context_->to_montgomery(x, this->limbs_.data());
+        }
+
+        void ModInt::check_context(const ModInt & other) const {
+            if (this->context_ == nullptr || other.context_ == nullptr) {
+                throw BigInt::invalid_argument();
+            }
+            if (this->context_ != other.context_ && this->context_->modulus() != other.context_->modulus()) {
+                throw BigInt::invalid_argument();
+            }
+        }
+
+        const BigInt & ModInt::modulus() const {
+            if (this->context_ == nullptr) {
+                throw BigInt::invalid_argument();
+            }
+            return this->context_->modulus();
+        }
+
+        BigInt ModInt::value() const {
+            if (this->context_ == nullptr) {
+                return BigInt();
+            }
+            return this->context_->from_montgomery(this->limbs_.data());
+        }
+
+        ModInt::operator BigInt() const {
+            return this->value();
+        }
+
+        ModInt & ModInt::operator+=(const ModInt & other) {
+            this->check_context(other);
+            this->context_->add(this->limbs_.data(), other.limbs_.data(), this->limbs_.data());
+            return *this;
+        }
+
+        ModInt & ModInt::operator-=(const ModInt & other) {
+            this->check_context(other);
+            this->context_->subtract(this->limbs_.data(), other.limbs_.data(), this->limbs_.data());
+            return *this;
+        }
+
+        ModInt & ModInt::operator*=(const ModInt & other) {
+            this->check_context(other);
+            this->context_->multiply(this->limbs_.data(), other.limbs_.data(), this->limbs_.data());
+            return *this;
+        }
+
+        ModInt operator+(const ModInt & first, const ModInt & second) {
+            ModInt result = first;
+            result += second;
+            return result;
+        }
+
+        ModInt operator-(const ModInt & first, const ModInt & second) {
+            ModInt result = first;
+            result -= second;
+            return result;
+        }
+
+        ModInt operator*(const ModInt & first, const ModInt & second) {
+            ModInt result = first;
+            result *= second;
+            return result;
+        }
+
+        ModInt operator+(ModInt && first, const ModInt & second) {
+            first += second;
+            return std::move(first);
+        }
+
+        ModInt operator+(const ModInt & first, ModInt && second) {
+            second += first;
+            return std::move(second);
+        }
+
+        ModInt operator+(ModInt && first, ModInt && second) {
+            first += second;
+            return std::move(first);
+        }
+
+        ModInt operator-(ModInt && first, const ModInt & second) {
+            first -= second;
+            return std::move(first);
+        }
+
+        ModInt operator-(const ModInt & first, ModInt && second) {
+            first.check_context(second);
+            first.context_->subtract(first.limbs_.data(), second.limbs_.data(), second.limbs_.data());
+            return std::move(second);
+        }
+
+        ModInt operator-(ModInt && first, ModInt && second) {
+            first -= second;
+            return std::move(first);
+        }
+
+        ModInt operator*(ModInt && first, const ModInt & second) {
+            first *= second;
+            return std::move(first);
+        }
+
+        ModInt operator*(const ModInt & first, ModInt && second) {
+            second *= first;
+            return std::move(second);
+        }
+
+        ModInt operator*(ModInt && first, ModInt && second) {
+            first *= second;
+            return std::move(first);
+        }
+
+        ModInt ModInt::operator-() const & {
+            return -ModInt(*this);
+        }
+
+        ModInt ModInt::operator-() && {
+            if (this->context_ != nullptr) {
+                this->context_->negate(this->limbs_.data(), this->limbs_.data());
+            }
+            return std::move(*this);
+        }
+
+        ModInt ModInt::pow(const BigInt & exp) const {
+            if (this->context_ == nullptr || exp < 0) {
+                throw BigInt::invalid_argument();
+            }
+            ModInt result = *this;
+            this->context_->pow(this->limbs_.data(), exp, result.limbs_.data());
+            return result;
+        }
+
+        bool ModInt::operator==(const ModInt & other) const {
+            if (this->context_ == nullptr || other.context_ == nullptr) {
+                return this->context_ == other.context_;
+            }
+            return this->modulus() == other.modulus() && std::equal(this->limbs_.begin(), this->limbs_.end(), other.limbs_.begin());
+        }
+
+        bool ModInt::operator!=(const ModInt & other) const {
+            return !(*this == other);
+        }
+
+        std::ostream & operator<<(std::ostream & ostream, const ModInt & mod_int) {
+            return ostream << mod_int.value();
+        }
 #endif
@@ -0,0 +1,348 @@
+//microbenchmarks for BigInt
+//build: g++ -std=c++17 -O2 benchmarks.cpp -o benchmarks
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "BigInt.h"
+
+//every heap allocation of the program goes through here, array forms included
+//out of line, so GCC does not match the built-in operator new against an inlined free
+static size_t allocations = 0;
+
+__attribute__((noinline)) void * operator new(size_t size) {
+    allocations++;
+    if (void * p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void * p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void * p, size_t) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void * operator new[](size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete[](void * p) noexcept {
+    operator delete(p);
+}
+
+__attribute__((noinline)) void operator delete[](void * p, size_t) noexcept {
+    operator delete(p);
+}
+
+//runs body n times, prints time and allocations per iteration
+template <typename F>
+void run(const char * name, size_t n, F body) {
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        body(i);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    //long operations are shown in milliseconds
+    bool ms = ns / n >= 1e6;
+    std::cout << std::left << std::setw(32) << name
+        << std::right << std::setw(10) << std::fixed << std::setprecision(1) << (ms ? ns / n / 1e6 : ns / n)
+        << (ms ? " ms" : " ns")
+        << std::setw(12) << std::setprecision(2) << double(allocations - before) / n << " allocs\n";
+}
+
+//small values: one to four limbs fit the inline buffer
+void small_values() {
+    const size_t n = 1'000'000;
+    BigInt a("123456789012345678901234567890");
+    BigInt b(987654321);
+    BigInt sink;
+    std::cout << "small values (" << n << " iterations)\n";
+    run("default construction", n, [&](size_t) { BigInt x; sink = x; });
+    run("construction from int", n, [&](size_t i) { BigInt x(static_cast<int>(i)); sink = x; });
+    run("copy", n, [&](size_t) { BigInt x(a); sink = x; });
+    run("a + b", n, [&](size_t) { sink = a + b; });
+    run("a * b", n, [&](size_t) { sink = a * b; });
+    run("a / b", n, [&](size_t) { sink = a / b; });
+    run("a += i", n, [&](size_t i) { sink += i; });
+    const std::string digits = "1234567890123456789012345678901234567890";
+    run("from_chars, 40 digits", n, [&](size_t) {
+        from_chars(digits.data(), digits.data() + digits.size(), sink);
+    });
+    char text[64];
+    run("to_chars, 30 digits", n, [&](size_t) { to_chars(text, text + sizeof(text), a); });
+    std::string str;
+    run("to_string, 30 digits", n, [&](size_t) { a.to_string(str); });
+    //the same copies with a plain heap vector as reference
+    std::vector<uint64_t> limbs(2, 1), vsink;
+    run("std::vector<uint64_t> copy", n, [&](size_t) { std::vector<uint64_t> x(limbs); vsink = x; });
+}
+
+//accumulation loops over numbers that live on the heap
+void accumulation() {
+    const size_t n = 100'000;
+    BigInt x(std::string(1000, '7'));
+    BigInt y(std::string(990, '3'));
+    BigInt acc;
+    std::cout << "accumulation of 1000-digit values (" << n << " iterations)\n";
+    run("acc += x", n, [&](size_t) { acc += x; });
+    run("acc -= y", n, [&](size_t) { acc -= y; });
+    run("acc = acc + x", n, [&](size_t) { acc = acc + x; });
+    run("acc = x + y - acc", n, [&](size_t) { acc = x + y - acc; });
+}
+
+//a * b + c * d - e with temporaries per operator and as one lazy expression
+void expressions() {
+    const size_t n = 100'000;
+    BigInt a(std::string(300, '7')), b(std::string(280, '3'));
+    BigInt c(std::string(290, '5')), d(std::string(300, '1'));
+    BigInt e(std::string(500, '9'));
+    BigInt x;
+    std::cout << "a * b + c * d - e, 300-digit operands (" << n << " iterations)\n";
+    run("temporaries", n, [&](size_t) { x = a * b + c * d - e; });
+    run("BigInt::lazy", n, [&](size_t) { x = BigInt::lazy(a) * b + BigInt::lazy(c) * d - e; });
+}
+
+//general products against squares of the same length
+void squaring() {
+    std::cout << "a * b against square(a)\n";
+    for (size_t digits : {300, 3'000, 30'000, 300'000}) {
+        BigInt a(std::string(digits, '7')), b(std::string(digits, '3')), x;
+        size_t n = 30'000'000 / digits / digits * 100 + 1;
+        std::string label = std::to_string(digits) + " digits";
+        run((label + ", a * b").c_str(), n, [&](size_t) { x = a * b; });
+        run((label + ", square(a)").c_str(), n, [&](size_t) { x = square(a); });
+    }
+}
+
+//powers by repeated multiplication and by pow
+void powers() {
+    BigInt three(3), x;
+    std::cout << "3^k\n";
+    for (uint64_t k : {1'000, 10'000, 100'000}) {
+        std::string label = "k = " + std::to_string(k);
+        run((label + ", loop").c_str(), 1, [&](size_t) {
+            x = 1;
+            for (uint64_t i = 0; i < k; i++) {
+                x *= three;
+            }
+        });
+        run((label + ", pow").c_str(), 1, [&](size_t) { x = pow(three, k); });
+    }
+    run("k = 10000000, pow", 1, [&](size_t) { x = pow(three, 10'000'000); });
+}
+
+//modular exponentiation with a full-size exponent
+void modular_powers() {
+    std::cout << "b^e mod m, b, e, m of the same length\n";
+    for (size_t bits : {2048, 4096, 8192}) {
+        //odd values with a fixed bit pattern
+        BigInt m = (BigInt(1) << bits) - BigInt("12345678901234567890123456789");
+        BigInt b = m / 3, e = m - BigInt("98765432109876543211"), x;
+        std::string label = std::to_string(bits) + " bits";
+        run((label + ", square and %").c_str(), 1, [&](size_t) {
+            x = 1;
+            for (size_t i = e.size() > 0 ? bits : 0; i > 0; i--) {
+                x = x * x % m;
+                if (((e >> (i - 1)) & BigInt(1)) == BigInt(1)) {
+                    x = x * b % m;
+                }
+            }
+        });
+        run((label + ", powmod").c_str(), 1, [&](size_t) { x = powmod(b, e, m); });
+    }
+}
+
+//chains of modular products under one modulus
+void modular_values() {
+    const size_t n = 10'000, bits = 2048;
+    BigInt m = (BigInt(1) << bits) - BigInt("12345678901234567890123456789");
+    BigInt a = m / 3, b = m / 5;
+    BigInt x = a;
+    ModContext context(m);
+    ModInt y = context(a), z = context(b);
+    std::cout << "x = x * b mod m, 2048 bits (" << n << " iterations)\n";
+    run("BigInt * and %", n, [&](size_t) { x = x * b % m; });
+    run("ModInt *=", n, [&](size_t) { y *= z; });
+    run("ModInt y = y * z + z - y", n, [&](size_t) { y = y * z + z - y; });
+
+    //values of a two-limb modulus are kept inline
+    ModContext small(BigInt("340282366920938463463374607431768211507"));
+    ModInt u = small(a), v = small(b);
+    std::cout << "temporaries, 128 bits (" << n << " iterations)\n";
+    run("ModInt u = u * v + v - u", n, [&](size_t) { u = u * v + v - u; });
+    run("ModInt u = -u", n, [&](size_t) { u = -u; });
+}
+
+//greatest common divisors
+void common_divisors() {
+    std::cout << "gcd\n";
+    for (size_t n : {1'000, 10'000, 100'000}) {
+        //digits of a linear congruential generator, patterns give untypically short remainder sequences
+        std::string digits(n, '0'), other(n, '0');
+        uint64_t state = 1;
+        for (size_t i = 0; i < n; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            digits[i] = '0' + (state >> 33) % 10;
+            other[i] = '0' + (state >> 45) % 10;
+        }
+        BigInt a(digits), b(other), g;
+        std::string label = std::to_string(n) + " digits";
+        if (n <= 10'000) {
+            run((label + ", euclid with %").c_str(), 1, [&](size_t) {
+                BigInt x = a, y = b;
+                while (y != 0) {
+                    BigInt r = x % y;
+                    x = std::move(y);
+                    y = std::move(r);
+                }
+                g = x;
+            });
+        }
+        run((label + ", gcd").c_str(), 1, [&](size_t) { g = gcd(a, b); });
+        run((label + ", xgcd").c_str(), 1, [&](size_t) { g = std::get<1>(xgcd(a, b)); });
+    }
+}
+
+//integer roots against a bisection on the root's bits
+void roots() {
+    std::cout << "roots\n";
+    for (size_t n : {1'000, 10'000, 100'000}) {
+        std::string digits(n, '0');
+        for (size_t i = 0; i < n; i++) {
+            digits[i] = '1' + (i * 7 + i / 3) % 9;
+        }
+        BigInt x(digits), r;
+        std::string label = std::to_string(n) + " digits";
+        if (n <= 1'000) {
+            run((label + ", bisection").c_str(), 1, [&](size_t) {
+                r = 0;
+                //the root of n digits is below 10^(n / 2 + 1) < 2^(2n + 4)
+                for (size_t bit = 2 * n + 4; bit > 0; bit--) {
+                    BigInt next = r + (BigInt(1) << (bit - 1));
+                    if (square(next) <= x) {
+                        r = std::move(next);
+                    }
+                }
+            });
+        }
+        run((label + ", isqrt").c_str(), 1, [&](size_t) { r = isqrt(x); });
+        run((label + ", iroot(x, 3)").c_str(), 1, [&](size_t) { r = iroot(x, 3); });
+        run((label + ", is_perfect_power").c_str(), 1, [&](size_t) { r = is_perfect_power(x); });
+    }
+}
+
+//n! by a running product and from the prime factorization
+void factorials() {
+    BigInt x;
+    std::cout << "n!\n";
+    for (uint64_t n : {1'000, 10'000, 100'000}) {
+        std::string label = "n = " + std::to_string(n);
+        run((label + ", x *= i").c_str(), 1, [&](size_t) {
+            x = 1;
+            for (uint64_t i = 2; i <= n; i++) {
+                x *= i;
+            }
+        });
+        run((label + ", factorial").c_str(), 1, [&](size_t) { x = factorial(n); });
+    }
+    run("n = 1000000, factorial", 1, [&](size_t) { x = factorial(1'000'000); });
+    run("binomial(1000000, 500000)", 1, [&](size_t) { x = binomial(1'000'000, 500'000); });
+    run("primorial(1000000)", 1, [&](size_t) { x = primorial(1'000'000); });
+}
+
+//sums and products of vectors, one operator per element against the range functions
+void ranges() {
+    std::vector<BigInt> values;
+    BigInt x(std::string(300, '7'));
+    for (size_t i = 0; i < 100'000; i++) {
+        values.push_back(x + i);
+    }
+    std::vector<BigInt> factors(values.begin(), values.begin() + 3'000);
+    BigInt r;
+    std::cout << "sum of 100000 and product of 3000 300-digit values\n";
+    run("acc = acc + x", 1, [&](size_t) {
+        r = 0;
+        for (const BigInt & v : values) {
+            r = r + v;
+        }
+    });
+    run("sum", 1, [&](size_t) { r = sum(values.begin(), values.end()); });
+    //chunks and subtrees run on the thread pool
+    BigInt::set_threads(4);
+    run("sum, set_threads(4)", 1, [&](size_t) { r = sum(values.begin(), values.end()); });
+    BigInt::set_threads(1);
+    run("acc *= x", 1, [&](size_t) {
+        r = 1;
+        for (const BigInt & v : factors) {
+            r *= v;
+        }
+    });
+    run("product", 1, [&](size_t) { r = product(factors.begin(), factors.end()); });
+    BigInt::set_threads(4);
+    run("product, set_threads(4)", 1, [&](size_t) { r = product(factors.begin(), factors.end()); });
+    BigInt::set_threads(1);
+}
+
+//long products and quotients against the number of threads
+void thread_scaling() {
+    BigInt a(std::string(1'000'000, '7')), b(std::string(1'000'000, '3')), x;
+    BigInt c(std::string(100'000, '7')), d(std::string(100'000, '3'));
+    BigInt e = a * b;
+    std::cout << "BigInt::set_threads, " << std::thread::hardware_concurrency() << " hardware threads\n";
+    for (size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        BigInt::set_threads(threads);
+        std::string label = std::to_string(threads) + " threads";
+        run((label + ", 1M digits, a * b").c_str(), 1, [&](size_t) { x = a * b; });
+        run((label + ", 100k digits, c * d").c_str(), 1, [&](size_t) { x = c * d; });
+        run((label + ", 2M / 1M digits").c_str(), 1, [&](size_t) { x = e / b; });
+    }
+    BigInt::set_threads(1);
+}
+
+//decimal parsing and printing of long numbers
+void conversion() {
+    std::cout << "decimal conversion\n";
+    for (size_t n : {10'000, 100'000, 1'000'000}) {
+        std::string digits(n, '0');
+        for (size_t i = 0; i < n; i++) {
+            digits[i] = '0' + (i * 7 + i / 3 + 1) % 10;
+        }
+        BigInt x;
+        std::string out;
+        std::string label = std::to_string(n) + " digits";
+        run((label + ", parse").c_str(), 1, [&](size_t) { x = BigInt(digits); });
+        run((label + ", from_chars").c_str(), 1, [&](size_t) {
+            from_chars(digits.data(), digits.data() + digits.size(), x);
+        });
+        std::stringstream stream(digits);
+        run((label + ", operator>>").c_str(), 1, [&](size_t) { stream >> x; });
+        run((label + ", print").c_str(), 1, [&](size_t) { out = (std::string)x; });
+        run((label + ", to_string").c_str(), 1, [&](size_t) { x.to_string(out); });
+        run((label + ", to_chars").c_str(), 1, [&](size_t) {
+            to_chars(&out[0], &out[0] + out.size(), x);
+        });
+        std::stringstream printed;
+        run((label + ", operator<<").c_str(), 1, [&](size_t) { printed << x; });
+    }
+}
+
+int main() {
+    small_values();
+    accumulation();
+    expressions();
+    squaring();
+    powers();
+    modular_powers();
+    modular_values();
+    common_divisors();
+    roots();
+    factorials();
+    ranges();
+    thread_scaling();
+    conversion();
+    return 0;
+}
@@ -21,13 +21,147 @@ TEST(Constructors, StringConstructor) {
         ss << num; 
         std::string str = ss.str();
         BigInt a(str);
+        ss.str(std::string());
         ss << a;
         std::string BigIntStr = ss.str();
-        EXPECT_STREQ(BigIntStr, str);
+        EXPECT_EQ(BigIntStr, str);
     }
     ASSERT_THROW({BigInt a("-9=5l");}, BigInt::invalid_argument);
 }
 
+TEST(Constructors, CopyConstructor) {
+    //values below and above the inline limb buffer
+    BigInt small("-12345678901234567890");
+    BigInt large(std::string(200, '7'));
+    BigInt a(small);
+    BigInt b(large);
+    EXPECT_EQ(a, small);
+    EXPECT_EQ(b, large);
+    a = large;
+    b = small;
+    EXPECT_EQ(a, large);
+    EXPECT_EQ(b, small);
+    a = a * a;
+    b = a;
+    a = small;
+    EXPECT_EQ(b, large * large);
+    EXPECT_EQ(a, small);
+    EXPECT_EQ((std::string)(large - large + small), "-12345678901234567890");
+}
+
+TEST(Constructors, DecimalConversion) {
+    //lengths around the limb-by-limb threshold and the split points 19 * 2^k
+    for (size_t n : {1, 19, 20, 608, 609, 1216, 1217, 9728, 9729, 100000}) {
+        std::string digits;
+        for (size_t i = 0; i < n; i++) {
+            digits += '0' + (i * 7 + i / 3 + 1) % 10;
+        }
+        digits[0] = '1';
+        EXPECT_EQ((std::string)BigInt(digits), digits);
+        EXPECT_EQ((std::string)BigInt("-" + digits), "-" + digits);
+    }
+
+    //long runs of zeros inside the split parts
+    for (size_t k : {19, 608, 1216, 9728}) {
+        BigInt power("1" + std::string(k, '0'));
+        EXPECT_EQ((std::string)power, "1" + std::string(k, '0'));
+        EXPECT_EQ((std::string)(power - 1), std::string(k, '9'));
+        EXPECT_EQ((std::string)(power + 1), "1" + std::string(k - 1, '0') + "1");
+    }
+}
+
+TEST(Constructors, CharRanges) {
+    std::string digits(5000, '0');
+    for (size_t i = 0; i < digits.size(); i++) {
+        digits[i] = '1' + i % 9;
+    }
+    std::string text = "-" + digits + "xyz";
+    BigInt a(text.data(), text.data() + digits.size() + 1);
+    EXPECT_EQ((std::string)a, "-" + digits);
+    EXPECT_EQ(BigInt(std::string_view(text).substr(1, 20)), BigInt(digits.substr(0, 20)));
+    EXPECT_THROW(BigInt(text.data(), text.data() + text.size()), BigInt::invalid_argument);
+
+    //from_chars reports errors without exceptions
+    BigInt b(7);
+    std::from_chars_result result = from_chars(text.data(), text.data() + text.size(), b);
+    EXPECT_TRUE(result.ec == std::errc());
+    EXPECT_EQ(result.ptr, text.data() + digits.size() + 1);
+    EXPECT_EQ(b, a);
+    result = from_chars(text.data() + digits.size() + 1, text.data() + text.size(), b);
+    EXPECT_TRUE(result.ec == std::errc::invalid_argument);
+    EXPECT_EQ(result.ptr, text.data() + digits.size() + 1);
+    EXPECT_EQ(b, a);
+}
+
+TEST(Constructors, InvalidDigits) {
+    //characters next to the digit range and outside ascii, at every offset of a vector block
+    //past 64 digits the run continues in the avx2 scan
+    std::string digits(200, '5');
+    for (char bad : {'/', ':', ' ', '\x80', '\xff', '\0'}) {
+        for (size_t i = 0; i < digits.size(); i++) {
+            std::string text = digits;
+            text[i] = bad;
+            EXPECT_THROW(BigInt{text}, BigInt::invalid_argument);
+            BigInt value;
+            std::from_chars_result result = from_chars(text.data(), text.data() + text.size(), value);
+            EXPECT_EQ(result.ptr, text.data() + i);
+        }
+    }
+}
+
+TEST(Constructors, StreamInput) {
+    std::string digits(5000, '0');
+    for (size_t i = 0; i < digits.size(); i++) {
+        digits[i] = '9' - i % 7;
+    }
+    std::stringstream ss("  -" + digits + "\n12 abc");
+    BigInt a, b, c(5);
+    ss >> a >> b;
+    EXPECT_EQ((std::string)a, "-" + digits);
+    EXPECT_EQ((std::string)b, "12");
+    ss >> c;
+    EXPECT_TRUE(ss.fail());
+    EXPECT_EQ(c, BigInt(5));
+
+    std::stringstream tail(digits);
+    tail >> a;
+    EXPECT_TRUE(tail.eof());
+    EXPECT_EQ((std::string)a, digits);
+}
+
+TEST(Constructors, DecimalOutput) {
+    std::string digits(3000, '0');
+    for (size_t i = 0; i < digits.size(); i++) {
+        digits[i] = '1' + i % 9;
+    }
+    //zeros in the middle of the number cross the chunk boundaries
+    std::fill(digits.begin() + 100, digits.begin() + 400, '0');
+    BigInt a("-" + digits);
+
+    char buffer[3100];
+    std::to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), a);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(std::string(buffer, result.ptr), "-" + digits);
+    result = to_chars(buffer, buffer + 3001, a);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(result.ptr, buffer + 3001);
+    result = to_chars(buffer, buffer + 3000, a);
+    EXPECT_EQ(result.ec, std::errc::value_too_large);
+    EXPECT_EQ(result.ptr, buffer + 3000);
+    result = to_chars(buffer, buffer + 1, BigInt());
+    EXPECT_EQ(std::string(buffer, result.ptr), "0");
+
+    std::string str(10000, 'x');
+    a.to_string(str);
+    EXPECT_EQ(str, "-" + digits);
+    BigInt(42).to_string(str);
+    EXPECT_EQ(str, "42");
+
+    std::stringstream ss;
+    ss << a << ' ' << std::setw(6) << std::setfill('*') << BigInt(-7);
+    EXPECT_EQ(ss.str(), "-" + digits + " ****-7");
+}
+
 TEST(ArithmeticOperators, DirectAssignment) {
     for (int i = 0; i < 10; i++) {
         int num1 = std::rand() % 1000 - 500;
@@ -41,7 +175,7 @@ TEST(ArithmeticOperators, DirectAssignment) {
         ss2 << b;
         std::string str1 = ss1.str();
         std::string str2 = ss2.str();
-        EXPECT_STREQ(str1, str2); 
+        EXPECT_EQ(str1, str2); 
     }
 }
 
@@ -56,7 +190,7 @@ TEST(UnaryOperators, UnaryPlus) {
         ss2 << a;
         std::string str1 = ss1.str();
         std::string str2 = ss2.str();
-        EXPECT_STREQ(str1, str2); 
+        EXPECT_EQ(str1, str2); 
     }
 }
 
@@ -71,7 +205,7 @@ TEST(UnaryOperators, UnaryMinus) {
         ss2 << a;
         std::string str1 = ss1.str();
         std::string str2 = ss2.str();
-        EXPECT_STRNE(str1, str2); 
+        EXPECT_NE(str1, str2); 
     }
 }
 
@@ -86,9 +220,9 @@ TEST(UnaryOperators, Increment) {
         ss2 << a;
         std::string str1 = ss1.str();
         std::string str2 = ss2.str();
-        EXPECT_STRNE(str1, str2);
-        int ch = str2.back() - str1.back();
-        EXPECT_EQ(ch, 1);
+        EXPECT_NE(str1, str2);
+        //the whole value, the last digits alone differ by 1 only without a carry
+        EXPECT_EQ(str2, std::to_string(num1 + 1));
     }
 }
 
@@ -103,9 +237,9 @@ TEST(UnaryOperators, Decrement) {
         ss2 << a;
         std::string str1 = ss1.str();
         std::string str2 = ss2.str();
-        EXPECT_STRNE(str1, str2); 
-        int ch = str1.back() - str2.back();
-        EXPECT_EQ(ch, 1);
+        EXPECT_NE(str1, str2); 
+        //the whole value, the last digits alone differ by 1 only without a borrow
+        EXPECT_EQ(str2, std::to_string(num1 - 1));
     }
 }
 
@@ -118,7 +252,7 @@ TEST(ArithmeticOperators, Addition) {
     ss << result;
     std::string result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "29");
+    EXPECT_EQ(result_str, "29");
 
     //2
     BigInt c("123456789123456789");
@@ -127,7 +261,7 @@ TEST(ArithmeticOperators, Addition) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "128507294173961839");
+    EXPECT_EQ(result_str, "128507294173961839");
 
     //3
     BigInt e("-105");
@@ -136,7 +270,7 @@ TEST(ArithmeticOperators, Addition) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "-105");
+    EXPECT_EQ(result_str, "-105");
 }
 
 TEST(ArithmeticOperators, Substraction) {
@@ -148,7 +282,7 @@ TEST(ArithmeticOperators, Substraction) {
     ss << result;
     std::string result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "9");
+    EXPECT_EQ(result_str, "9");
 
     //2
     BigInt c("123456789123456789");
@@ -157,7 +291,7 @@ TEST(ArithmeticOperators, Substraction) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "118406284072951739");
+    EXPECT_EQ(result_str, "118406284072951739");
 
     //3
     BigInt e("0");
@@ -166,7 +300,7 @@ TEST(ArithmeticOperators, Substraction) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "-105");
+    EXPECT_EQ(result_str, "-105");
 }
 
 TEST(ArithmeticOperators, Multiplication) {
@@ -178,7 +312,7 @@ TEST(ArithmeticOperators, Multiplication) {
     ss << result;
     std::string result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "190");
+    EXPECT_EQ(result_str, "190");
 
     //2
     BigInt c("123456789123456789");
@@ -187,7 +321,7 @@ TEST(ArithmeticOperators, Multiplication) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "623519136987155437648086301284450");
+    EXPECT_EQ(result_str, "623519136987155437648086301284450");
 
     //3
     BigInt e("0");
@@ -196,7 +330,474 @@ TEST(ArithmeticOperators, Multiplication) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "0");
+    EXPECT_EQ(result_str, "0");
+}
+
+TEST(ArithmeticOperators, LargeMultiplication) {
+    //(10^k - 1)^2 = 10^2k - 2 * 10^k + 1 goes through karatsuba
+    for (int k : {100, 1000, 5000}) {
+        std::string nines(k, '9');
+        BigInt a(nines);
+        std::string expected = std::string(k - 1, '9') + "8" + std::string(k - 1, '0') + "1";
+        EXPECT_EQ((std::string)(a * a), expected);
+        EXPECT_EQ((std::string)(a * -a), "-" + expected);
+    }
+
+    //unbalanced operands
+    BigInt b(std::string(20000, '9'));
+    BigInt c(std::string(300, '9'));
+    std::string expected = std::string(299, '9') + "8" + std::string(19700, '9')
+        + std::string(299, '0') + "1";
+    EXPECT_EQ((std::string)(b * c), expected);
+    EXPECT_EQ((std::string)(c * b), expected);
+}
+
+TEST(ArithmeticOperators, ToomMultiplication) {
+    std::string digits;
+    for (int i = 0; i < 30000; i++) {
+        digits += '0' + (i * 7 + i / 13) % 10;
+    }
+    BigInt a(digits.substr(0, 27000));
+    BigInt b("-" + digits.substr(1000, 9000));
+    BigInt c(digits.substr(5, 2000));
+    //(a + b) * (a - b) = a^2 - b^2
+    EXPECT_EQ((a + b) * (a - b), a * a - b * b);
+    //a * (b + c) = a * b + a * c
+    EXPECT_EQ(a * (b + c), a * b + a * c);
+    EXPECT_EQ(b * a, a * b);
+
+    //unbalanced operands
+    BigInt d(std::string(450000, '9'));
+    BigInt e(std::string(27000, '9'));
+    std::string expected = std::string(26999, '9') + "8" + std::string(423000, '9')
+        + std::string(26999, '0') + "1";
+    EXPECT_EQ((std::string)(d * e), expected);
+}
+
+TEST(ArithmeticOperators, NTTMultiplication) {
+    //million-digit operands go through the number-theoretic transform
+    int k = 1000000;
+    BigInt a(std::string(k, '9'));
+    std::string expected = std::string(k - 1, '9') + "8" + std::string(k - 1, '0') + "1";
+    EXPECT_EQ((std::string)(a * a), expected);
+
+    std::string digits;
+    for (int i = 0; i < 200000; i++) {
+        digits += '0' + (i * 3 + i / 7) % 10;
+    }
+    BigInt b(digits);
+    BigInt c("-" + digits.substr(0, 90000));
+    BigInt d(digits.substr(10000, 100000));
+    EXPECT_EQ((b + c) * (b - c), b * b - c * c);
+    EXPECT_EQ(b * (c + d), b * c + b * d);
+}
+
+TEST(ArithmeticOperators, Squaring) {
+    std::string digits;
+    for (int i = 0; i < 400000; i++) {
+        digits += '0' + (i * 7 + i / 11) % 10;
+    }
+    //every squaring algorithm against the general product of a copy
+    for (size_t n : {1, 20, 600, 1500, 5000, 400000}) {
+        BigInt a("-" + digits.substr(0, n));
+        BigInt copy(a);
+        BigInt expected = a * copy;
+        EXPECT_EQ(square(a), expected);
+        EXPECT_EQ(a * a, expected);
+        a *= a;
+        EXPECT_EQ(a, expected);
+    }
+
+    //all limbs at their maximum
+    BigInt b = (BigInt(1) << 64 * 100) - 1;
+    EXPECT_EQ(square(b), (BigInt(1) << 64 * 200) - (BigInt(1) << (64 * 100 + 1)) + 1);
+    EXPECT_EQ(square(BigInt()), BigInt());
+}
+
+TEST(ArithmeticOperators, Power) {
+    EXPECT_EQ((std::string)pow(BigInt(-3), 5), "-243");
+    EXPECT_EQ((std::string)pow(BigInt(-3), 4), "81");
+    EXPECT_EQ((std::string)pow(BigInt(12), 20), "3833759992447475122176");
+    EXPECT_EQ(pow(BigInt(0), 0), BigInt(1));
+    EXPECT_EQ(pow(BigInt(0), 7), BigInt(0));
+    EXPECT_EQ(pow(BigInt(-1), 1001), BigInt(-1));
+    EXPECT_EQ(pow(BigInt(2), 1000), BigInt(1) << 1000);
+    EXPECT_EQ((std::string)pow(BigInt(10), 500), "1" + std::string(500, '0'));
+
+    //long exponents with all window shapes against the repeated product
+    BigInt a("-123456789012345678901234567891");
+    BigInt expected(1);
+    for (int i = 0; i < 300; i++) {
+        expected *= a;
+    }
+    EXPECT_EQ(pow(a, 300), expected);
+    EXPECT_EQ(pow(a, 100000) * pow(a, 23457), pow(a, 123457));
+}
+
+TEST(ArithmeticOperators, ModularPower) {
+    EXPECT_EQ(powmod(BigInt(4), BigInt(13), BigInt(497)), BigInt(445));
+    EXPECT_EQ(powmod(BigInt(-4), BigInt(13), BigInt(497)), BigInt(52));
+    EXPECT_EQ(powmod(BigInt(4), BigInt(13), BigInt(-497)), BigInt(445));
+    EXPECT_EQ(powmod(BigInt(3), BigInt(200), BigInt(1000)), BigInt(1));
+    EXPECT_EQ(powmod(BigInt(7), BigInt(0), BigInt(1)), BigInt(0));
+    EXPECT_EQ(powmod(BigInt(7), BigInt(0), BigInt(10)), BigInt(1));
+    EXPECT_THROW(powmod(BigInt(7), BigInt(3), BigInt(0)), BigInt::divide_by_zero);
+    EXPECT_THROW(powmod(BigInt(7), BigInt(-3), BigInt(5)), BigInt::invalid_argument);
+
+    //fermat's little theorem for the mersenne prime 2^521 - 1
+    BigInt p = (BigInt(1) << 521) - BigInt(1);
+    BigInt a("123456789012345678901234567890123456789");
+    EXPECT_EQ(powmod(a, p - BigInt(1), p), BigInt(1));
+    EXPECT_EQ(powmod(a, p, p), a);
+
+    //odd and even moduli against pow and %
+    BigInt b("-98765432109876543210987654321");
+    for (BigInt m : {BigInt("1000000000000000000000000000057"), BigInt("1000000000000000000000000000056")}) {
+        EXPECT_EQ(powmod(b, BigInt(301), m), pow(b, 301) % m);
+    }
+}
+
+TEST(ArithmeticOperators, ModularValues) {
+    BigInt m = (BigInt(1) << 2203) - BigInt(1);
+    ModContext context(m);
+    BigInt a("-123456789012345678901234567890123456789"), b = m / 7 + BigInt(5);
+    ModInt x = context(a), y(context, b);
+    EXPECT_EQ(x.value(), a % m);
+    EXPECT_EQ((x + y).value(), (a + b) % m);
+    EXPECT_EQ((x - y).value(), (a - b) % m);
+    EXPECT_EQ((y - x).value(), (b - a) % m);
+    EXPECT_EQ((x * y).value(), a * b % m);
+    EXPECT_EQ((-x).value(), (m - a % m) % m);
+    EXPECT_EQ(x.pow(BigInt(1000)).value(), powmod(a, BigInt(1000), m));
+    EXPECT_EQ((std::string)(BigInt)context(BigInt(0)), "0");
+
+    //a chain of in-place operations
+    ModInt acc = context(BigInt(1));
+    BigInt expected(1);
+    for (int i = 0; i < 50; i++) {
+        acc *= x;
+        acc += y;
+        acc -= context(BigInt(i));
+        expected = ((expected * a + b - BigInt(i)) % m + m) % m;
+    }
+    EXPECT_EQ(acc.value(), expected);
+
+    //values of equal moduli mix, of different moduli throw
+    ModContext same(m), other(BigInt(1000003));
+    EXPECT_EQ(same(a) * y, x * y);
+    EXPECT_THROW(x * other(a), BigInt::invalid_argument);
+    EXPECT_THROW(ModContext(BigInt(1000)), BigInt::invalid_argument);
+}
+
+TEST(UnaryOperators, NegativeZero) {
+    BigInt zero;
+    BigInt a("-123456789123456789123456789");
+    EXPECT_EQ((std::string)(-zero), "0");
+    EXPECT_EQ((std::string)(-(a - a)), "0");
+    EXPECT_EQ((std::string)(-(-zero)), "0");
+    EXPECT_EQ(-zero, zero);
+    EXPECT_FALSE(-zero < zero);
+    EXPECT_EQ((std::string)(-zero + a), (std::string)a);
+    EXPECT_EQ((std::string)((-zero) * a), "0");
+}
+
+TEST(ArithmeticOperators, GreatestCommonDivisor) {
+    EXPECT_EQ(gcd(BigInt(12), BigInt(-18)), BigInt(6));
+    EXPECT_EQ(gcd(BigInt(0), BigInt(-5)), BigInt(5));
+    EXPECT_EQ(gcd(BigInt(0), BigInt(0)), BigInt(0));
+    EXPECT_EQ(modinv(BigInt(3), BigInt(7)), BigInt(5));
+    EXPECT_EQ(modinv(BigInt(-3), BigInt(7)), BigInt(2));
+    EXPECT_THROW(modinv(BigInt(6), BigInt(9)), BigInt::invalid_argument);
+    EXPECT_THROW(modinv(BigInt(6), BigInt(0)), BigInt::divide_by_zero);
+
+    //fibonacci neighbours are the worst case of euclid's algorithm
+    BigInt f0(0), f1(1);
+    for (int i = 0; i < 3000; i++) {
+        BigInt next = f0 + f1;
+        f0 = std::move(f1);
+        f1 = std::move(next);
+    }
+    EXPECT_EQ(gcd(f1, f0), BigInt(1));
+
+    //a large common factor through lehmer and half-gcd sizes
+    std::string digits;
+    for (int i = 0; i < 60000; i++) {
+        digits += '1' + (i * 7 + i / 5) % 9;
+    }
+    BigInt g(digits.substr(0, 20000));
+    BigInt a = g * BigInt(digits.substr(100, 30000)) * 9, b = -g * BigInt(digits.substr(200, 25000)) * 6;
+    BigInt d = gcd(a, b);
+    EXPECT_EQ(d % g, BigInt(0));
+    EXPECT_EQ(gcd(a / d, b / d), BigInt(1));
+    for (const BigInt & x : {a, BigInt(digits.substr(0, 500)), BigInt(digits.substr(0, 7000))}) {
+        for (const BigInt & y : {b, BigInt("-" + digits.substr(3, 480)), BigInt(digits.substr(3, 7100))}) {
+            std::tuple<BigInt, BigInt, BigInt> r = xgcd(x, y);
+            EXPECT_EQ(std::get<0>(r), gcd(x, y));
+            EXPECT_EQ(x * std::get<1>(r) + y * std::get<2>(r), std::get<0>(r));
+        }
+    }
+    BigInt m(digits.substr(0, 10000) + "1");
+    BigInt inverse = modinv(a, m);
+    EXPECT_EQ(a * inverse % m, BigInt(1));
+}
+
+TEST(ArithmeticOperators, Roots) {
+    EXPECT_EQ(isqrt(BigInt(0)), BigInt(0));
+    EXPECT_EQ(isqrt(BigInt(99)), BigInt(9));
+    EXPECT_EQ(isqrt(BigInt(100)), BigInt(10));
+    EXPECT_THROW(isqrt(BigInt(-1)), BigInt::invalid_argument);
+    EXPECT_EQ(iroot(BigInt(-27), 3), BigInt(-3));
+    EXPECT_EQ(iroot(BigInt(80), 4), BigInt(2));
+    EXPECT_THROW(iroot(BigInt(-16), 4), BigInt::invalid_argument);
+    EXPECT_THROW(iroot(BigInt(16), 0), BigInt::invalid_argument);
+    EXPECT_TRUE(is_perfect_power(BigInt(-32)));
+    EXPECT_TRUE(is_perfect_power(BigInt(1)));
+    EXPECT_FALSE(is_perfect_power(BigInt(-4)));
+    EXPECT_FALSE(is_perfect_power(BigInt(72)));
+
+    //roots of exact powers and of their neighbours, from one limb to newton sizes
+    std::string digits;
+    for (int i = 0; i < 20000; i++) {
+        digits += '1' + (i * 7 + i / 5) % 9;
+    }
+    for (size_t n : {5, 19, 40, 300, 4000, 20000}) {
+        BigInt y(digits.substr(0, n));
+        BigInt x = square(y);
+        std::pair<BigInt, BigInt> r = sqrtrem(x - 1);
+        EXPECT_EQ(r.first, y - 1);
+        EXPECT_EQ(r.second, y + y - 2);
+        EXPECT_EQ(sqrtrem(x + y + y).first, y);
+        EXPECT_EQ(isqrt(x), y);
+        for (uint64_t k : {3, 7, 64}) {
+            BigInt p = pow(y, k);
+            EXPECT_EQ(iroot(p, k), y);
+            EXPECT_EQ(iroot(p - 1, k), y - 1);
+            if (n <= 300) {
+                EXPECT_TRUE(is_perfect_power(p));
+            }
+        }
+    }
+    EXPECT_FALSE(is_perfect_power(BigInt(digits.substr(0, 300)) * BigInt(digits.substr(1, 300))));
+}
+
+TEST(ArithmeticOperators, Factorials) {
+    EXPECT_EQ(factorial(0), BigInt(1));
+    EXPECT_EQ(factorial(20), BigInt("2432902008176640000"));
+    EXPECT_EQ(binomial(5, 7), BigInt(0));
+    EXPECT_EQ(binomial(52, 5), BigInt(2598960));
+    EXPECT_EQ(primorial(1), BigInt(1));
+    EXPECT_EQ(primorial(30), BigInt("6469693230"));
+
+    //running products through exponents with many bits
+    BigInt f(1);
+    for (uint64_t n = 1; n <= 3000; n++) {
+        f *= n;
+        if (n % 997 == 0 || n == 3000) {
+            EXPECT_EQ(factorial(n), f);
+        }
+    }
+    EXPECT_EQ(factorial(3000) / factorial(1200) / factorial(1800), binomial(3000, 1200));
+    EXPECT_EQ(binomial(3000, 1800), binomial(3000, 1200));
+    //the numerator product for small k
+    EXPECT_EQ(binomial(100000, 3), BigInt("166661666700000"));
+    EXPECT_EQ(binomial(100000, 1000), binomial(99999, 999) + binomial(99999, 1000));
+
+    BigInt p(1);
+    for (uint64_t n = 2; n <= 2000; n++) {
+        if (gcd(p, BigInt(static_cast<int>(n))) == 1) {
+            p *= n;
+        }
+    }
+    EXPECT_EQ(primorial(2000), p);
+}
+
+TEST(ArithmeticOperators, Ranges) {
+    std::vector<BigInt> empty;
+    EXPECT_EQ(sum(empty.begin(), empty.end()), BigInt(0));
+    EXPECT_EQ(product(empty.begin(), empty.end()), BigInt(1));
+    std::vector<int> ints = {1, -2, 3, -4, 5};
+    EXPECT_EQ(sum(ints.begin(), ints.end()), BigInt(3));
+    EXPECT_EQ(product(ints.begin(), ints.end()), BigInt(120));
+
+    //mixed signs and lengths, carries out of every limb, a negative result
+    std::vector<BigInt> values;
+    BigInt ones = (BigInt(1) << static_cast<size_t>(64 * 20)) - 1;
+    for (int i = 0; i < 5000; i++) {
+        BigInt x = ones >> static_cast<size_t>(i % 1300);
+        values.push_back(i % 3 == 0 ? -x * 2 : x);
+    }
+    BigInt s, p(1);
+    for (const BigInt & x : values) {
+        s += x;
+    }
+    for (int i = 0; i < 300; i++) {
+        p *= values[i];
+    }
+    EXPECT_TRUE(s < 0);
+    std::list<BigInt> list(values.begin(), values.end());
+    EXPECT_EQ(sum(list.begin(), list.end()), s);
+    for (size_t threads : {1, 2, 7}) {
+        EXPECT_EQ(sum(values.begin(), values.end(), threads), s);
+        EXPECT_EQ(product(values.begin(), values.begin() + 300, threads), p);
+    }
+    //enough limbs for the threaded sum
+    std::vector<BigInt> many(70000, ones);
+    EXPECT_EQ(sum(many.begin(), many.end(), 4), ones * 70000);
+}
+
+TEST(ArithmeticOperators, Threads) {
+    //toom-3 and ntt sizes, products and quotients must not depend on the number of threads
+    std::string digits;
+    for (int i = 0; i < 400000; i++) {
+        digits += '1' + (i * 7 + i / 5) % 9;
+    }
+    std::vector<BigInt> values;
+    for (size_t n : {12000, 60000, 400000}) {
+        values.push_back(BigInt(digits.substr(0, n)));
+        values.push_back(-BigInt(digits.substr(n / 3, n / 2)));
+    }
+    std::vector<BigInt> expected;
+    for (size_t i = 0; i < values.size(); i += 2) {
+        expected.push_back(values[i] * values[i + 1]);
+        expected.push_back(square(values[i]));
+        expected.push_back(values[i] / values[i + 1]);
+    }
+    for (size_t threads : {2, 5}) {
+        BigInt::set_threads(threads);
+        EXPECT_EQ(BigInt::threads(), threads);
+        for (size_t i = 0; i < values.size(); i += 2) {
+            EXPECT_EQ(values[i] * values[i + 1], expected[i / 2 * 3]);
+            EXPECT_EQ(square(values[i]), expected[i / 2 * 3 + 1]);
+            EXPECT_EQ(values[i] / values[i + 1], expected[i / 2 * 3 + 2]);
+        }
+    }
+    BigInt::set_threads(1);
+    EXPECT_EQ(BigInt::threads(), 1u);
+}
+
+TEST(BitwiseOperators, ShiftAmountTypes) {
+    //every native shift type picks the BigInt shift, not int << int through operator int
+    BigInt a("123456789123456789123456789");
+    BigInt expected = a * pow(BigInt(2), 70);
+    EXPECT_EQ(a << 70, expected);
+    EXPECT_EQ(a << 70u, expected);
+    EXPECT_EQ(a << 70L, expected);
+    EXPECT_EQ(a << static_cast<size_t>(70), expected);
+    EXPECT_EQ(a << static_cast<unsigned char>(70), expected);
+    EXPECT_EQ(expected >> 70, a);
+    EXPECT_EQ(expected >> 70ULL, a);
+    EXPECT_EQ(expected >> static_cast<short>(70), a);
+    EXPECT_EQ((std::string)(BigInt(1) << 64), "18446744073709551616");
+    EXPECT_EQ((std::string)(BigInt(-5) >> 1), "-3");
+    BigInt b(a);
+    b <<= 3;
+    b >>= 3;
+    EXPECT_EQ(b, a);
+    EXPECT_THROW(a << -1, BigInt::invalid_argument);
+    EXPECT_THROW(a >> -1, BigInt::invalid_argument);
+}
+
+TEST(ArithmeticOperators, RepeatedNewtonDivision) {
+    std::string digits;
+    for (int i = 0; i < 120000; i++) {
+        digits += '0' + (i * 7 + i / 17) % 10;
+    }
+    BigInt a(digits.substr(0, 60000));
+    BigInt b(digits.substr(1, 40000));
+    BigInt c(digits.substr(50, 30000));
+    BigInt d(digits.substr(3, 45000));
+
+    //divisions by the same divisor reuse its reciprocal, other divisors and signs replace it
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ((a * b + c) / b, a);
+        EXPECT_EQ((a * b + c) % b, c);
+        EXPECT_EQ((a * b + c) / -b, -a);
+        EXPECT_EQ(-(a * b + c) / b, -a);
+        EXPECT_EQ((a * d + c) / d, a);
+        EXPECT_EQ(-(a * d + c) % -d, d - c);
+        std::pair<BigInt, BigInt> qr = divmod(a * b + c + BigInt(i), b);
+        EXPECT_EQ(qr.first, a);
+        EXPECT_EQ(qr.second, c + BigInt(i));
+    }
+}
+
+TEST(Constructors, DigitChunks) {
+    //every length up to 33 chunks, odd and even numbers of full chunks
+    std::string digits;
+    BigInt expected;
+    for (int i = 0; i < 650; i++) {
+        int digit = (i * 7 + i / 3) % 10;
+        digits += '0' + digit;
+        expected = expected * 10 + digit;
+        BigInt value;
+        from_chars(digits.data(), digits.data() + digits.size(), value);
+        EXPECT_EQ(value, expected);
+    }
+}
+
+TEST(ArithmeticOperators, ModularTemporaries) {
+    for (BigInt m : {BigInt("1000000007"), BigInt("340282366920938463463374607431768211507"), (BigInt(1) << 2203) - BigInt(1)}) {
+        ModContext context(m);
+        BigInt a("-123456789012345678901234567890123456789"), b = m / 7 + BigInt(5), c = m / 3;
+        ModInt x = context(a), y = context(b), z = context(c);
+        //every combination of temporary and named operands
+        EXPECT_EQ((x * y + z).value(), (a * b + c) % m);
+        EXPECT_EQ((z + x * y).value(), (c + a * b) % m);
+        EXPECT_EQ((x * y + y * z).value(), (a * b + b * c) % m);
+        EXPECT_EQ((x * y - z).value(), (a * b - c) % m);
+        EXPECT_EQ((z - x * y).value(), (c - a * b) % m);
+        EXPECT_EQ((x * y - y * z).value(), (a * b - b * c) % m);
+        EXPECT_EQ(((x + y) * z).value(), (a + b) * c % m);
+        EXPECT_EQ((z * (x + y)).value(), c * (a + b) % m);
+        EXPECT_EQ(((x + y) * (y + z)).value(), (a + b) * (b + c) % m);
+        EXPECT_EQ((-(x + y)).value(), (m - (a + b) % m) % m);
+        EXPECT_EQ((-context(BigInt(0))).value(), BigInt(0));
+        EXPECT_EQ(-(-x), x);
+        EXPECT_EQ(x + -x, context(BigInt(0)));
+        //the named operands are left alone
+        EXPECT_EQ(x.value(), a % m);
+        EXPECT_EQ(y.value(), b % m);
+        EXPECT_THROW(ModInt() - (x + y), BigInt::invalid_argument);
+    }
+}
+
+TEST(ArithmeticOperators, ThreadsFromOutside) {
+    //threads outside the pool fork into the shared queue at the same time
+    std::string digits;
+    for (int i = 0; i < 100000; i++) {
+        digits += '1' + (i * 7 + i / 5) % 9;
+    }
+    BigInt a(digits.substr(0, 60000)), b(digits.substr(7, 50000));
+    BigInt expected = a * b;
+    std::vector<BigInt> factors;
+    for (int i = 1; i <= 3000; i++) {
+        factors.push_back(BigInt(i) * BigInt(digits.substr(i, 40)));
+    }
+    BigInt expected_product = product(factors.begin(), factors.end());
+    BigInt expected_sum = sum(factors.begin(), factors.end());
+
+    BigInt::set_threads(3);
+    std::vector<int> correct(4, 0);
+    std::vector<std::thread> callers;
+    for (size_t t = 0; t < correct.size(); t++) {
+        callers.emplace_back([&, t] {
+            for (int i = 0; i < 3; i++) {
+                correct[t] += a * b == expected;
+                correct[t] += product(factors.begin(), factors.end()) == expected_product;
+            }
+        });
+    }
+    for (std::thread & caller : callers) {
+        caller.join();
+    }
+    for (int count : correct) {
+        EXPECT_EQ(count, 6);
+    }
+    //sum and product default to the threads of set_threads
+    EXPECT_EQ(product(factors.begin(), factors.end()), expected_product);
+    EXPECT_EQ(sum(factors.begin(), factors.end()), expected_sum);
+    EXPECT_EQ(product(factors.begin(), factors.end(), 16), expected_product);
+    BigInt::set_threads(1);
 }
 
 TEST(ArithmeticOperators, Division) {
@@ -208,7 +809,7 @@ TEST(ArithmeticOperators, Division) {
     ss << result;
     std::string result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "1");
+    EXPECT_EQ(result_str, "1");
 
     //2
     BigInt c("123456789123456789");
@@ -217,7 +818,7 @@ TEST(ArithmeticOperators, Division) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "2");
+    EXPECT_EQ(result_str, "24");
 
     //3
     BigInt e("0");
@@ -226,7 +827,51 @@ TEST(ArithmeticOperators, Division) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "0");
+    EXPECT_EQ(result_str, "0");
+}
+
+TEST(ArithmeticOperators, LargeDivision) {
+    std::string digits;
+    for (int i = 0; i < 20000; i++) {
+        digits += '0' + (i * 7 + i / 11) % 10;
+    }
+    BigInt a(digits.substr(0, 15000));
+    BigInt b(digits.substr(3, 4000));
+    BigInt c(digits.substr(100, 3000));
+    //(a * b + c) / b = a when c < b
+    EXPECT_EQ((a * b + c) / b, a);
+    EXPECT_EQ((a * b + c) % b, c);
+    EXPECT_EQ(-(a * b + c) / b, -a);
+    EXPECT_EQ((a * b) / -a, -b);
+    EXPECT_EQ(c / a, BigInt(0));
+
+    //single limb divisor
+    BigInt d(std::string(5000, '9'));
+    EXPECT_EQ((std::string)(d / BigInt(3)), std::string(5000, '3'));
+    EXPECT_EQ((std::string)(d / BigInt(-9)), "-" + std::string(5000, '1'));
+}
+
+TEST(ArithmeticOperators, NewtonDivision) {
+    std::string digits;
+    for (int i = 0; i < 120000; i++) {
+        digits += '0' + (i * 7 + i / 17) % 10;
+    }
+    BigInt a(digits.substr(0, 60000));
+    BigInt b(digits.substr(1, 40000));
+    BigInt c(digits.substr(50, 30000));
+    EXPECT_EQ((a * b + c) / b, a);
+    EXPECT_EQ((a * b + c) % b, c);
+    EXPECT_EQ(-(a * b + c) / a, -b);
+
+    //the same divisor reused for several dividends
+    BigInt::reciprocal r(b);
+    EXPECT_EQ(r.quotient(a * b + c), a);
+    EXPECT_EQ(r.remainder(a * b + c), c);
+    EXPECT_EQ(r.quotient(c), BigInt(0));
+    EXPECT_EQ(r.remainder(-c), b - c);
+    BigInt d(digits);
+    EXPECT_EQ(r.quotient(d) * b + r.remainder(d), d);
+    EXPECT_THROW(BigInt::reciprocal(BigInt(0)), BigInt::divide_by_zero);
 }
 
 TEST(ArithmeticOperators, Modulo) {
@@ -238,7 +883,7 @@ TEST(ArithmeticOperators, Modulo) {
     ss << result;
     std::string result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "9");
+    EXPECT_EQ(result_str, "9");
 
     //2
     BigInt c("123456789123456789");
@@ -247,7 +892,7 @@ TEST(ArithmeticOperators, Modulo) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "113355779022446689");
+    EXPECT_EQ(result_str, "2244667911335589");
 
     //3
     BigInt e("0");
@@ -256,7 +901,151 @@ TEST(ArithmeticOperators, Modulo) {
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "0");
+    EXPECT_EQ(result_str, "0");
+}
+
+TEST(ArithmeticOperators, DivMod) {
+    BigInt a("123456789123456789123456789");
+    BigInt b("5050505050505050");
+    std::pair<BigInt, BigInt> qr = divmod(a, b);
+    EXPECT_EQ(qr.first, a / b);
+    EXPECT_EQ(qr.second, a % b);
+    EXPECT_EQ(qr.first * b + qr.second, a);
+
+    //the remainder stays in [0, |b|) for every sign combination
+    for (int sign = 0; sign < 4; sign++) {
+        BigInt x = sign & 1 ? -a : a;
+        BigInt y = sign & 2 ? -b : b;
+        qr = divmod(x, y);
+        EXPECT_EQ(qr.first, x / y);
+        EXPECT_EQ(qr.second, x % y);
+        EXPECT_TRUE(qr.second >= BigInt(0) && qr.second < b);
+    }
+    EXPECT_EQ((std::string)divmod(BigInt(-7), BigInt(-3)).second, "2");
+
+    BigInt c = a;
+    c /= b;
+    EXPECT_EQ(c, a / b);
+    c = a;
+    c %= b;
+    EXPECT_EQ(c, a % b);
+    EXPECT_THROW(divmod(a, BigInt(0)), BigInt::divide_by_zero);
+}
+
+TEST(ArithmeticOperators, NativeIntegers) {
+    BigInt a("123456789123456789123456789");
+    long long int b = -987654321987654321LL;
+    EXPECT_EQ(a + b, a + BigInt("-987654321987654321"));
+    EXPECT_EQ(a - b, a - BigInt("-987654321987654321"));
+    EXPECT_EQ(b - a, BigInt("-987654321987654321") - a);
+    EXPECT_EQ(a * b, a * BigInt("-987654321987654321"));
+    EXPECT_EQ(b * a, a * b);
+    EXPECT_EQ(a / b, a / BigInt("-987654321987654321"));
+    EXPECT_EQ(a % b, a % BigInt("-987654321987654321"));
+    EXPECT_EQ(-a % 10, BigInt(1));
+    EXPECT_EQ(a / 1000000000U, BigInt("123456789123456789"));
+    EXPECT_THROW(a / 0, BigInt::divide_by_zero);
+
+    EXPECT_TRUE(BigInt(5) == 5);
+    EXPECT_TRUE(-3 < BigInt(2));
+    EXPECT_TRUE(a > b);
+    EXPECT_TRUE(BigInt(0) >= 0U);
+    EXPECT_TRUE(BigInt("-18446744073709551615") <= -9223372036854775807LL);
+
+    BigInt c(999999999);
+    EXPECT_EQ((std::string)(++c), "1000000000");
+    EXPECT_EQ((std::string)(--c), "999999999");
+    BigInt d(0);
+    d--;
+    EXPECT_EQ((std::string)d, "-1");
+    d++;
+    EXPECT_EQ((std::string)d, "0");
+
+    EXPECT_EQ(BigInt(0).size(), 1);
+    EXPECT_EQ(BigInt(-99).size(), 2);
+    EXPECT_EQ(BigInt("1000000000").size(), 10);
+}
+
+TEST(ArithmeticOperators, MoveAndCompound) {
+    BigInt a(std::string(300, '9'));
+    BigInt b("-123456789123456789123456789");
+    BigInt c(a);
+    BigInt d(std::move(c));
+    EXPECT_EQ(d, a);
+    EXPECT_EQ(c, BigInt(0));
+    c = std::move(d);
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(d, BigInt(0));
+
+    //rvalue operands donate their limbs
+    EXPECT_EQ(BigInt(a) + b, a + b);
+    EXPECT_EQ(a + BigInt(b), a + b);
+    EXPECT_EQ(BigInt(a) - b, a - b);
+    EXPECT_EQ(b - BigInt(a), b - a);
+    EXPECT_EQ((a * b) - (b * b), a * b - b * b);
+
+    //temporaries mixed with native integers
+    EXPECT_EQ((a + b) + 1, a + b + BigInt(1));
+    EXPECT_EQ(1 + (a + b), a + b + BigInt(1));
+    EXPECT_EQ((a + b) - 1, a + b - BigInt(1));
+    EXPECT_EQ(1 - (a + b), BigInt(1) - a - b);
+    EXPECT_EQ((std::string)(5 - (BigInt(2) + BigInt(3))), "0");
+    EXPECT_EQ((std::string)(-7LL - (a - a)), "-7");
+
+    //in-place accumulation, including aliasing
+    BigInt acc;
+    for (int i = 0; i < 10; i++) {
+        acc += a;
+        acc -= b;
+    }
+    EXPECT_EQ(acc, (a - b) * 10);
+    acc += acc;
+    EXPECT_EQ(acc, (a - b) * 20);
+    acc -= acc;
+    EXPECT_EQ((std::string)acc, "0");
+    acc -= a;
+    EXPECT_EQ(acc, -a);
+}
+
+TEST(ArithmeticOperators, LazyExpressions) {
+    BigInt a("123456789123456789123456789123456789");
+    BigInt b("-98765432109876543210");
+    BigInt c(std::string(1500, '7'));
+    BigInt d("-3");
+    BigInt e(std::string(700, '5'));
+    BigInt x = BigInt::lazy(a) * b + BigInt::lazy(c) * d - e;
+    EXPECT_EQ(x, a * b + c * d - e);
+    x = e - BigInt::lazy(c) * c;
+    EXPECT_EQ(x, e - c * c);
+    x = (BigInt::lazy(a) + b) * (BigInt::lazy(c) - d);
+    EXPECT_EQ(x, (a + b) * (c - d));
+
+    //the destination may be an operand
+    x = a;
+    x = BigInt::lazy(x) * x - b;
+    EXPECT_EQ(x, a * a - b);
+
+    //results that cancel out
+    x = BigInt::lazy(a) * b - BigInt::lazy(b) * a;
+    EXPECT_EQ((std::string)x, "0");
+}
+
+TEST(ArithmeticOperators, LimbBoundaries) {
+    //2^64 - 1 and 2^128 - 1
+    BigInt a("18446744073709551615");
+    BigInt b("340282366920938463463374607431768211455");
+    EXPECT_EQ((std::string)(a + 1), "18446744073709551616");
+    EXPECT_EQ((std::string)(a + 1 - 1), "18446744073709551615");
+    EXPECT_EQ((std::string)(1 - (a + 1)), "-18446744073709551615");
+    EXPECT_EQ((std::string)(b * (a + 2)), "6277101735386680764176071790128604879547283307822093172735");
+    EXPECT_EQ((std::string)((b + 1) / a), "18446744073709551617");
+    EXPECT_EQ((std::string)((b + 1) % a), "1");
+    EXPECT_EQ(a.size(), 20);
+    EXPECT_EQ((a + 1).size(), 20);
+    EXPECT_EQ(BigInt("10000000000000000000").size(), 20);
+    EXPECT_EQ(BigInt("9999999999999999999").size(), 19);
+    EXPECT_EQ((int)BigInt("-2147483648"), -2147483647 - 1);
+    EXPECT_THROW((int)BigInt("2147483648"), BigInt::out_of_bound);
 }
 
 TEST(BoolOperators, Equality) {
@@ -264,13 +1053,13 @@ TEST(BoolOperators, Equality) {
     BigInt a(19);
     BigInt b(10);
     bool result = (a == b);
-    EXPECT_STREQ(result, false);
+    EXPECT_EQ(result, false);
 
     //2
     BigInt c("123456789123456789");
     BigInt d("123456789123456789");
     result = (c == d);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 }
 
 TEST(BoolOperators, NotEquality) {
@@ -278,13 +1067,13 @@ TEST(BoolOperators, NotEquality) {
     BigInt a(19);
     BigInt b(10);
     bool result = (a != b);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 
     //2
     BigInt c("123456789123456789");
     BigInt d("123456789123456789");
     result = (c != d);
-    EXPECT_STREQ(result, false);
+    EXPECT_EQ(result, false);
 }
 
 TEST(BoolOperators, LessThan) {
@@ -292,13 +1081,13 @@ TEST(BoolOperators, LessThan) {
     BigInt a(19);
     BigInt b(10);
     bool result = (b < a);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 
     //2
     BigInt c("123456789123456789");
     BigInt d("123456789123456789");
     result = (c < d);
-    EXPECT_STREQ(result, false);
+    EXPECT_EQ(result, false);
 }
 
 TEST(BoolOperators, GreaterThan) {
@@ -306,13 +1095,13 @@ TEST(BoolOperators, GreaterThan) {
     BigInt a(19);
     BigInt b(10);
     bool result = (a > b);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 
     //2
     BigInt c("123456789123456789");
     BigInt d("123456789123456789");
     result = (c > d);
-    EXPECT_STREQ(result, false);
+    EXPECT_EQ(result, false);
 }
 
 TEST(BoolOperators, EqualityOrLessThan) {
@@ -320,13 +1109,13 @@ TEST(BoolOperators, EqualityOrLessThan) {
     BigInt a(19);
     BigInt b(10);
     bool result = (b <= a);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 
     //2
     BigInt c("123456789123456789");
     BigInt d("123456789123456789");
     result = (c <= d);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 }
 
 TEST(BoolOperators, EqualityOrGreaterThan) {
@@ -334,13 +1123,13 @@ TEST(BoolOperators, EqualityOrGreaterThan) {
     BigInt a(19);
     BigInt b(10);
     bool result = (a >= b);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 
     //2
     BigInt c("123456789123456789");
     BigInt d("123456789123456789");
     result = (c >= d);
-    EXPECT_STREQ(result, true);
+    EXPECT_EQ(result, true);
 }
 
 TEST(BitwiseOperators, NOT) {
@@ -351,15 +1140,46 @@ TEST(BitwiseOperators, NOT) {
     ss << result;
     std::string result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "-4");
+    EXPECT_EQ(result_str, "-124");
 
     //2
-    BigInt b(123456789123456789);
+    BigInt b("123456789123456789");
     result = ~b;
     ss << result;
     result_str = ss.str();
     ss.str(std::string());
-    EXPECT_STREQ(result_str, "1395630319");
+    EXPECT_EQ(result_str, "-123456789123456790");
+}
+
+TEST(BitwiseOperators, AndOrXor) {
+    BigInt a("123456789123456789123456789012345678901234567890");
+    BigInt b("-98765432109876543210987654321");
+    EXPECT_EQ((std::string)(a & b), "123456789123456789122489609390165657331395199554");
+    EXPECT_EQ((std::string)(a | b), "-97798252487696521641148285985");
+    EXPECT_EQ((std::string)(a ^ b), "-123456789123456789220287861877862178972543485539");
+    EXPECT_EQ((std::string)(-a & b), "-123456789123456789221255041500042200542382853874");
+    EXPECT_EQ((std::string)(-a | b), "-967179622180021569839368337");
+    EXPECT_EQ((std::string)(-a ^ b), "123456789123456789220287861877862178972543485537");
+    EXPECT_EQ(a ^ a, BigInt(0));
+    EXPECT_EQ(b & ~b, BigInt(0));
+}
+
+TEST(BitwiseOperators, Shifts) {
+    BigInt a("123456789123456789123456789012345678901234567890");
+    BigInt b("-98765432109876543210987654321");
+    EXPECT_EQ((std::string)(a << 100), "156500072834599941898774713579653145819278257118926973536814597484617284976640");
+    EXPECT_EQ((std::string)(b << 64), "-1821900649460228180197516091617929708512514932736");
+    EXPECT_EQ((std::string)(a >> 70), "104571967949794254252780601");
+    EXPECT_EQ((std::string)(b >> 64), "-5354084803");
+    EXPECT_EQ((std::string)(b >> 63), "-10708169606");
+    EXPECT_EQ((std::string)(BigInt(-1) >> 5), "-1");
+    EXPECT_EQ((std::string)(b >> 1000), "-1");
+    EXPECT_EQ(((a << 77) >> 77), a);
+    BigInt c(1);
+    c <<= 128;
+    c = -c;
+    c >>= 64;
+    EXPECT_EQ((std::string)c, "-18446744073709551616");
 }
 
 int main(int argc, char **argv) {